@@ -0,0 +1,19 @@
+// engine/bench.h  (fixed-depth search benchmark over embedded positions)
+#pragma once
+
+#include "search.h"
+
+#include <ostream>
+
+struct BenchResult {
+    int positions = 0;
+    u64 nodes = 0;
+    u64 qnodes = 0;
+    long long timeMs = 0;
+    u64 signature = 0;   // nodes + qnodes; identical across runs and machines when threads == 1
+    SearchProfile profile;   // summed over the positions (ORRYX_STATS builds only)
+};
+
+// Searches every bench position to `depth` from an empty TT, logging one line per
+// position to log. With threads > 1 the counts vary from run to run (Lazy SMP).
+BenchResult runBench(int depth, int threads, int hashMB, std::ostream& log);
@@ -0,0 +1,128 @@
+// engine/bitboard.cpp
+#include "bitboard.h"
+
+#include <random>
+
+// Ray directions: positive deltas scan towards h8 (use lsb), negative towards a1 (use msb).
+enum Dir { DIR_N=0, DIR_S, DIR_E, DIR_W, DIR_NE, DIR_NW, DIR_SE, DIR_SW };
+static const int DIR_DF[8] = { 0, 0, 1,-1, 1,-1, 1,-1 };
+static const int DIR_DR[8] = { 1,-1, 0, 0, 1, 1,-1,-1 };
+static const int DIR_OPP[8] = { DIR_S, DIR_N, DIR_W, DIR_E, DIR_SW, DIR_SE, DIR_NW, DIR_NE };
+static bool dirPositive(int d){ return d==DIR_N || d==DIR_E || d==DIR_NE || d==DIR_NW; }
+
+AttackTables::AttackTables(){
+    static const int kD[8][2]={{1,2},{2,1},{-1,2},{-2,1},{1,-2},{2,-1},{-1,-2},{-2,-1}};
+    for(int sq=0; sq<64; sq++){
+        int f=sq%8, r=sq/8;
+        auto add = [&](Bitboard& bb, int nf, int nr){
+            if(nf>=0&&nf<8&&nr>=0&&nr<8) bb |= bit(nr*8+nf);
+        };
+        for(auto& d: kD) add(knight[sq], f+d[0], r+d[1]);
+        for(int df=-1; df<=1; df++)
+            for(int dr=-1; dr<=1; dr++)
+                if(df||dr) add(king[sq], f+df, r+dr);
+        add(pawn[0][sq], f-1, r+1); add(pawn[0][sq], f+1, r+1);
+        add(pawn[1][sq], f-1, r-1); add(pawn[1][sq], f+1, r-1);
+
+        for(int d=0; d<8; d++){
+            int nf=f+DIR_DF[d], nr=r+DIR_DR[d];
+            while(nf>=0&&nf<8&&nr>=0&&nr<8){
+                ray[d][sq] |= bit(nr*8+nf);
+                nf+=DIR_DF[d]; nr+=DIR_DR[d];
+            }
+        }
+    }
+
+    // Needs every ray filled in, hence the second pass.
+    for(int sq=0; sq<64; sq++){
+        for(int d=0; d<8; d++){
+            Bitboard full = ray[d][sq] | ray[DIR_OPP[d]][sq] | bit(sq);
+            Bitboard r = ray[d][sq];
+            while(r){
+                int s = popLsb(r);
+                between[sq][s] = ray[d][sq] ^ ray[d][s] ^ bit(s);
+                line[sq][s] = full;
+            }
+        }
+    }
+}
+// Defined before SLIDERS: the slider tables are built from these rays.
+const AttackTables ATT;
+
+static Bitboard rayAttacks(int sq, Bitboard occ, int d){
+    Bitboard a = ATT.ray[d][sq];
+    Bitboard blockers = a & occ;
+    if(blockers){
+        int s = dirPositive(d) ? lsb(blockers) : msb(blockers);
+        a ^= ATT.ray[d][s];
+    }
+    return a;
+}
+// Ray-scan slider attacks: only used to build the lookup tables below.
+static Bitboard slowBishopAttacks(int sq, Bitboard occ){
+    return rayAttacks(sq,occ,DIR_NE) | rayAttacks(sq,occ,DIR_NW) | rayAttacks(sq,occ,DIR_SE) | rayAttacks(sq,occ,DIR_SW);
+}
+static Bitboard slowRookAttacks(int sq, Bitboard occ){
+    return rayAttacks(sq,occ,DIR_N) | rayAttacks(sq,occ,DIR_S) | rayAttacks(sq,occ,DIR_E) | rayAttacks(sq,occ,DIR_W);
+}
+
+SliderTables::SliderTables(){
+    init(bishop, bishopTable, slowBishopAttacks);
+    init(rook, rookTable, slowRookAttacks);
+}
+
+void SliderTables::init(Magic* m, Bitboard* table, Bitboard (*slow)(int, Bitboard)){
+    std::mt19937_64 rng(0x5EED0F0A11ULL);
+    auto sparse = [&](){ return rng() & rng() & rng(); };
+
+    Bitboard occs[4096], refs[4096];
+    int epoch[4096]{};
+    int cnt = 0;
+    Bitboard* next = table;
+
+    for(int sq=0; sq<64; sq++){
+        int f=sq%8, r=sq/8;
+        // Edge squares never affect the attack set unless the piece sits on that edge.
+        Bitboard edges = ((rankBB(0) | rankBB(7)) & ~rankBB(r)) | ((fileBB(0) | fileBB(7)) & ~fileBB(f));
+        Magic& mg = m[sq];
+        mg.mask = slow(sq, 0) & ~edges;
+        mg.shift = unsigned(64 - popcount(mg.mask));
+        mg.attacks = next;
+
+        // Carry-Rippler enumeration of all subsets of the mask.
+        int size = 0;
+        Bitboard sub = 0;
+        do {
+            occs[size] = sub;
+            refs[size] = slow(sq, sub);
+#if ORRYX_USE_PEXT
+            mg.attacks[_pext_u64(sub, mg.mask)] = refs[size];
+#endif
+            size++;
+            sub = (sub - mg.mask) & mg.mask;
+        } while(sub);
+        next += size;
+
+#if !ORRYX_USE_PEXT
+        for(;;){
+            mg.magic = sparse();
+            if(popcount((mg.mask * mg.magic) >> 56) < 6) continue;
+            cnt++;
+            bool ok = true;
+            for(int i=0; i<size && ok; i++){
+                unsigned idx = mg.index(occs[i]);
+                if(epoch[idx] < cnt){
+                    epoch[idx] = cnt;
+                    mg.attacks[idx] = refs[i];
+                } else if(mg.attacks[idx] != refs[i]){
+                    ok = false;
+                }
+            }
+            if(ok) break;
+        }
+#else
+        (void)sparse; (void)epoch; (void)cnt;
+#endif
+    }
+}
+const SliderTables SLIDERS;
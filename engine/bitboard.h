@@ -0,0 +1,109 @@
+// engine/bitboard.h  (bitboard helpers and attack lookups)
+#pragma once
+
+#include "types.h"
+
+// ======================== Bitboards ========================
+// Square index = rank*8 + file (a1=0, h8=63), same as the mailbox.
+using Bitboard = u64;
+
+inline Bitboard bit(int sq){ return Bitboard(1) << sq; }
+inline int popcount(Bitboard x){ return __builtin_popcountll(x); }
+inline int lsb(Bitboard x){ return __builtin_ctzll(x); }
+inline int msb(Bitboard x){ return 63 - __builtin_clzll(x); }
+inline int popLsb(Bitboard& x){ int s = lsb(x); x &= x - 1; return s; }
+
+constexpr Bitboard FILE_A_BB = 0x0101010101010101ULL;
+constexpr Bitboard RANK_1_BB = 0x00000000000000FFULL;
+inline Bitboard fileBB(int f){ return FILE_A_BB << f; }
+inline constexpr Bitboard rankBB(int r){ return RANK_1_BB << (8*r); }
+
+struct AttackTables {
+    Bitboard knight[64]{};
+    Bitboard king[64]{};
+    Bitboard pawn[2][64]{};   // [color][square] squares attacked by a pawn of that colour
+    Bitboard ray[8][64]{};    // [dir][square] empty-board ray, excluding the origin
+    Bitboard between[64][64]{};  // squares strictly between two aligned squares, else 0
+    Bitboard line[64][64]{};     // full board line through two aligned squares, else 0
+
+    AttackTables();
+};
+extern const AttackTables ATT;
+
+// ======================== Slider attack tables (magic / PEXT) ========================
+// "Fancy" magic bitboards: each square owns a slice of a shared table indexed by
+// ((occ & mask) * magic) >> shift. When the compiler targets BMI2 (e.g. -march=native
+// on Haswell+ / Zen 3+) the index is computed with PEXT instead and no magics are needed.
+// Define ORRYX_NO_PEXT to force the magic path on BMI2 builds (slow PEXT on Zen 1/2).
+#if defined(__BMI2__) && !defined(ORRYX_NO_PEXT)
+#define ORRYX_USE_PEXT 1
+#include <immintrin.h>
+#else
+#define ORRYX_USE_PEXT 0
+#endif
+
+struct Magic {
+    Bitboard mask=0;
+    Bitboard magic=0;
+    Bitboard* attacks=nullptr;
+    unsigned shift=0;
+
+    unsigned index(Bitboard occ) const {
+#if ORRYX_USE_PEXT
+        return (unsigned)_pext_u64(occ, mask);
+#else
+        return unsigned(((occ & mask) * magic) >> shift);
+#endif
+    }
+};
+
+struct SliderTables {
+    Magic bishop[64];
+    Magic rook[64];
+    Bitboard bishopTable[0x1480]{};   // 5248 entries  (sum of 2^bits over squares)
+    Bitboard rookTable[0x19000]{};    // 102400 entries
+
+    SliderTables();
+    static void init(Magic* m, Bitboard* table, Bitboard (*slow)(int, Bitboard));
+};
+extern const SliderTables SLIDERS;
+
+inline Bitboard bishopAttacks(int sq, Bitboard occ){
+    const Magic& m = SLIDERS.bishop[sq];
+    return m.attacks[m.index(occ)];
+}
+inline Bitboard rookAttacks(int sq, Bitboard occ){
+    const Magic& m = SLIDERS.rook[sq];
+    return m.attacks[m.index(occ)];
+}
+inline Bitboard queenAttacks(int sq, Bitboard occ){
+    return bishopAttacks(sq,occ) | rookAttacks(sq,occ);
+}
+inline Bitboard knightAttacks(int sq){ return ATT.knight[sq]; }
+inline Bitboard kingAttacks(int sq){ return ATT.king[sq]; }
+inline Bitboard pawnAttacks(Color c, int sq){ return ATT.pawn[(int)c][sq]; }
+inline Bitboard betweenBB(int a, int b){ return ATT.between[a][b]; }
+inline Bitboard lineBB(int a, int b){ return ATT.line[a][b]; }
+
+// Compile-time piece type, for generators specialised per piece (no switch in the loop).
+template<PieceType Pt>
+inline Bitboard attacksOf(int sq, Bitboard occ){
+    static_assert(Pt!=PieceType::Pawn && Pt!=PieceType::None, "pawn attacks depend on the colour");
+    if constexpr(Pt==PieceType::Knight) return knightAttacks(sq);
+    else if constexpr(Pt==PieceType::Bishop) return bishopAttacks(sq, occ);
+    else if constexpr(Pt==PieceType::Rook) return rookAttacks(sq, occ);
+    else if constexpr(Pt==PieceType::Queen) return queenAttacks(sq, occ);
+    else return kingAttacks(sq);
+}
+
+inline Bitboard pieceAttacks(PieceType t, Color c, int sq, Bitboard occ){
+    switch(t){
+        case PieceType::Pawn:   return pawnAttacks(c, sq);
+        case PieceType::Knight: return knightAttacks(sq);
+        case PieceType::Bishop: return bishopAttacks(sq, occ);
+        case PieceType::Rook:   return rookAttacks(sq, occ);
+        case PieceType::Queen:  return queenAttacks(sq, occ);
+        case PieceType::King:   return kingAttacks(sq);
+        default: return 0;
+    }
+}
@@ -0,0 +1,831 @@
+// engine/board.cpp
+#include "board.h"
+#include "nnue.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+void Board::reset(){
+    clear();
+    auto set = [&](int file, int rank, Color c, PieceType t){
+        putPiece(rank*8 + file, Piece{t,c});
+    };
+
+    // White
+    set(0,0,Color::White,PieceType::Rook);
+    set(1,0,Color::White,PieceType::Knight);
+    set(2,0,Color::White,PieceType::Bishop);
+    set(3,0,Color::White,PieceType::Queen);
+    set(4,0,Color::White,PieceType::King);
+    set(5,0,Color::White,PieceType::Bishop);
+    set(6,0,Color::White,PieceType::Knight);
+    set(7,0,Color::White,PieceType::Rook);
+    for(int f=0; f<8; f++) set(f,1,Color::White,PieceType::Pawn);
+
+    // Black
+    set(0,7,Color::Black,PieceType::Rook);
+    set(1,7,Color::Black,PieceType::Knight);
+    set(2,7,Color::Black,PieceType::Bishop);
+    set(3,7,Color::Black,PieceType::Queen);
+    set(4,7,Color::Black,PieceType::King);
+    set(5,7,Color::Black,PieceType::Bishop);
+    set(6,7,Color::Black,PieceType::Knight);
+    set(7,7,Color::Black,PieceType::Rook);
+    for(int f=0; f<8; f++) set(f,6,Color::Black,PieceType::Pawn);
+
+    stm = Color::White;
+    epSquare = -1;
+    castling = 0b1111;
+    halfmoveClock=0;
+
+    recomputeHash();
+}
+
+bool Board::setFen(const std::string& fen){
+    std::istringstream in(fen);
+    std::string placement, side, rights, ep;
+    if(!(in >> placement >> side >> rights >> ep)) return false;
+    int halfmove = 0;
+    in >> halfmove;   // optional, as is the fullmove number read below
+
+    Board nb;
+    nb.z = z;
+    nb.clear();
+
+    int rank = 7, file = 0;
+    for(char ch : placement){
+        if(ch=='/'){
+            if(file!=8 || rank==0) return false;
+            rank--; file=0;
+            continue;
+        }
+        if(ch>='1' && ch<='8'){
+            file += ch-'0';
+            if(file>8) return false;
+            continue;
+        }
+        PieceType t = PieceType::None;
+        switch(ch | 0x20){
+            case 'p': t = PieceType::Pawn; break;
+            case 'n': t = PieceType::Knight; break;
+            case 'b': t = PieceType::Bishop; break;
+            case 'r': t = PieceType::Rook; break;
+            case 'q': t = PieceType::Queen; break;
+            case 'k': t = PieceType::King; break;
+            default: return false;
+        }
+        if(file>7) return false;
+        nb.putPiece(rank*8 + file, Piece{t, (ch>='a') ? Color::Black : Color::White});
+        file++;
+    }
+    if(rank!=0 || file!=8) return false;
+    if(popcount(nb.pieces[0][(int)PieceType::King])!=1 || popcount(nb.pieces[1][(int)PieceType::King])!=1) return false;
+    // Pawns on the back ranks would be pushed off the board by move generation.
+    if((nb.pieces[0][(int)PieceType::Pawn] | nb.pieces[1][(int)PieceType::Pawn]) & (rankBB(0) | rankBB(7))) return false;
+
+    if(side=="w") nb.stm = Color::White;
+    else if(side=="b") nb.stm = Color::Black;
+    else return false;
+    if(nb.inCheck(other(nb.stm))) return false;   // the side to move could take the king
+
+    nb.castling = 0;
+    if(rights!="-"){
+        for(char ch : rights){
+            switch(ch){
+                case 'K': nb.castling |= 0b0001; break;
+                case 'Q': nb.castling |= 0b0010; break;
+                case 'k': nb.castling |= 0b0100; break;
+                case 'q': nb.castling |= 0b1000; break;
+                default: return false;
+            }
+        }
+    }
+
+    // The en passant square is the one an enemy pawn just skipped: behind it, with its
+    // start square empty again.
+    nb.epSquare = -1;
+    if(ep!="-"){
+        bool white = (nb.stm==Color::White);
+        if(ep.size()!=2 || ep[0]<'a' || ep[0]>'h' || ep[1]!=(white ? '6' : '3')) return false;
+        int sq = (ep[1]-'1')*8 + (ep[0]-'a');
+        int pawnSq = white ? sq - 8 : sq + 8;
+        int startSq = white ? sq + 8 : sq - 8;
+        Piece pawn = nb.at(pawnSq);
+        if(pawn.t!=PieceType::Pawn || pawn.c==nb.stm || !isNone(nb.at(sq)) || !isNone(nb.at(startSq))) return false;
+        nb.epSquare = sq;
+    }
+
+    int fullmove = 1;
+    in >> fullmove;
+    nb.halfmoveClock = std::max(0, halfmove);
+    nb.fullmoveNumber = std::max(1, fullmove);
+    nb.recomputeHash();
+    // Stay attached to the caller's accumulator stack, restarted at the new position.
+    nb.nn = nn;
+    if(nn) nn->reset();
+    *this = nb;
+    return true;
+}
+
+std::string Board::fen() const {
+    static const char LETTER[] = " pnbrqk";
+    std::string s;
+    for(int rank=7; rank>=0; rank--){
+        int empty = 0;
+        for(int file=0; file<8; file++){
+            Piece p = b[rank*8 + file];
+            if(isNone(p)){ empty++; continue; }
+            if(empty){ s += char('0' + empty); empty = 0; }
+            char ch = LETTER[(int)p.t];
+            s += (p.c==Color::White) ? char(ch - 'a' + 'A') : ch;
+        }
+        if(empty) s += char('0' + empty);
+        if(rank) s += '/';
+    }
+    s += (stm==Color::White) ? " w " : " b ";
+    if(!castling) s += '-';
+    if(castling & 0b0001) s += 'K';
+    if(castling & 0b0010) s += 'Q';
+    if(castling & 0b0100) s += 'k';
+    if(castling & 0b1000) s += 'q';
+    s += ' ';
+    s += (epSquare>=0) ? sqName(indexToSq(epSquare)) : std::string("-");
+    s += ' ' + std::to_string(halfmoveClock) + ' ' + std::to_string(fullmoveNumber);
+    return s;
+}
+
+void Board::recomputeHash(){
+    if(!z){ hash=0; pawnKey=0; return; }
+    u64 h=0;
+    for(int c=0;c<2;c++){
+        for(int pt=1;pt<7;pt++){
+            Bitboard bb = pieces[c][pt];
+            while(bb) h ^= z->psq[c][pt][popLsb(bb)];
+        }
+    }
+    u64 pk=0;
+    for(int c=0;c<2;c++){
+        Bitboard bb = pieces[c][(int)PieceType::Pawn];
+        while(bb) pk ^= z->psq[c][(int)PieceType::Pawn][popLsb(bb)];
+    }
+    pawnKey = pk;
+    if(stm==Color::Black) h ^= z->sideToMove;
+    h ^= z->castling[castling & 0xF];
+    int epF = 8;
+    if(epSquare>=0) epF = epSquare % 8;
+    h ^= z->epFile[epF];
+    hash = h;
+}
+
+// ======================== Move generation ========================
+// The generators are templates on the side to move and the kind of moves wanted, so the
+// pawn direction, start and promotion ranks, the capture/quiet split and the piece type of
+// each loop are all compile-time constants; generate(), genCastling() and genLegal() only
+// pick the instance.
+namespace {
+
+inline void pushMove(MoveList& out, int from, int to, bool cap=false, bool ep=false, bool castle=false, PieceType promo=PieceType::None){
+    Move m;
+    m.from=(u8)from; m.to=(u8)to;
+    m.isCapture=cap; m.isEnPassant=ep; m.isCastle=castle; m.promo=promo;
+    out.push_back(m);
+}
+inline void pushPromos(MoveList& out, int from, int to, bool cap){
+    pushMove(out, from, to, cap, false, false, PieceType::Queen);
+    pushMove(out, from, to, cap, false, false, PieceType::Rook);
+    pushMove(out, from, to, cap, false, false, PieceType::Bishop);
+    pushMove(out, from, to, cap, false, false, PieceType::Knight);
+}
+
+// Moves of every Pt of the side to move, restricted to targets (allowed(from) narrows it per
+// piece for the legal generator).
+template<Color Us, PieceType Pt, class Allowed>
+inline void genPieceMoves(const Board& bd, MoveList& out, Bitboard targets, Bitboard fromMask, Allowed allowed){
+    const Bitboard enemy = bd.occ[(int)other(Us)];
+    const Bitboard all = bd.occupied();
+    Bitboard bb = bd.pieces[(int)Us][(int)Pt] & fromMask;
+    while(bb){
+        int from = popLsb(bb);
+        Bitboard t = attacksOf<Pt>(from, all) & targets & allowed(from);
+        while(t){
+            int to = popLsb(t);
+            pushMove(out, from, to, (enemy & bit(to)) != 0);
+        }
+    }
+}
+
+template<Color Us>
+void genCastlingFor(const Board& bd, MoveList& out){
+    constexpr Color Them = other(Us);
+    constexpr int K = (Us==Color::White) ? 4 : 60;             // king's start square
+    constexpr u8 KING_SIDE  = (Us==Color::White) ? 0b0001 : 0b0100;
+    constexpr u8 QUEEN_SIDE = (Us==Color::White) ? 0b0010 : 0b1000;
+    if(bd.findKing(Us)!=K) return;
+
+    const Bitboard all = bd.occupied();
+    auto ownRook = [&](int sq){ return bd.b[sq].t==PieceType::Rook && bd.b[sq].c==Us; };
+    if((bd.castling & KING_SIDE) && !(all & (bit(K+1)|bit(K+2))) && ownRook(K+3)){
+        if(!bd.inCheck(Us) && !bd.isSquareAttacked(K+1, Them) && !bd.isSquareAttacked(K+2, Them))
+            pushMove(out, K, K+2, false, false, true);
+    }
+    if((bd.castling & QUEEN_SIDE) && !(all & (bit(K-1)|bit(K-2)|bit(K-3))) && ownRook(K-4)){
+        if(!bd.inCheck(Us) && !bd.isSquareAttacked(K-1, Them) && !bd.isSquareAttacked(K-2, Them))
+            pushMove(out, K, K-2, false, false, true);
+    }
+}
+
+template<Color Us, GenType Type>
+void genPseudo(const Board& bd, MoveList& out){
+    static_assert(Type!=GenType::Evasions, "evasions come from the legal generator");
+    constexpr Color Them = other(Us);
+    constexpr int UP = (Us==Color::White) ? 8 : -8;
+    constexpr Bitboard START_RANK = rankBB((Us==Color::White) ? 1 : 6);
+    constexpr Bitboard PROMO_RANK = rankBB((Us==Color::White) ? 7 : 0);
+    constexpr bool CAPS   = (Type != GenType::Quiets);
+    constexpr bool QUIETS = (Type != GenType::Captures);
+
+    const Bitboard enemy = bd.occ[(int)Them];
+    const Bitboard all = bd.occupied();
+
+    Bitboard pawns = bd.pieces[(int)Us][(int)PieceType::Pawn];
+    while(pawns){
+        int from = popLsb(pawns);
+        int one = from + UP;
+        if(!(all & bit(one))){
+            if(bit(one) & PROMO_RANK){
+                if constexpr(CAPS) pushPromos(out, from, one, false);
+            } else if constexpr(QUIETS){
+                pushMove(out, from, one);
+                int two = one + UP;
+                if((bit(from) & START_RANK) && !(all & bit(two))) pushMove(out, from, two);
+            }
+        }
+        if constexpr(CAPS){
+            Bitboard caps = pawnAttacks(Us, from) & enemy;
+            while(caps){
+                int to = popLsb(caps);
+                if(bit(to) & PROMO_RANK) pushPromos(out, from, to, true);
+                else pushMove(out, from, to, true);
+            }
+
+            if(bd.epSquare>=0 && (pawnAttacks(Us, from) & bit(bd.epSquare))){
+                int adj = bd.epSquare - UP;
+                if(bd.b[adj].t==PieceType::Pawn && bd.b[adj].c==Them)
+                    pushMove(out, from, bd.epSquare, true, true);
+            }
+        }
+    }
+
+    const Bitboard targets = (CAPS ? enemy : 0) | (QUIETS ? ~all : 0);
+    auto any = [](int){ return ~Bitboard(0); };
+    genPieceMoves<Us, PieceType::Knight>(bd, out, targets, ~Bitboard(0), any);
+    genPieceMoves<Us, PieceType::Bishop>(bd, out, targets, ~Bitboard(0), any);
+    genPieceMoves<Us, PieceType::Rook>  (bd, out, targets, ~Bitboard(0), any);
+    genPieceMoves<Us, PieceType::Queen> (bd, out, targets, ~Bitboard(0), any);
+    genPieceMoves<Us, PieceType::King>  (bd, out, targets, ~Bitboard(0), any);
+
+    if constexpr(QUIETS) genCastlingFor<Us>(bd, out);
+}
+
+// Fully legal moves of the pieces in fromMask, appended to out: directly from the checkers
+// and pinned pieces, with no make/undo per move. In check this is exactly the evasions.
+template<Color Us>
+void genLegalFor(const Board& bd, MoveList& out, Bitboard fromMask){
+    constexpr Color Them = other(Us);
+    constexpr int UP = (Us==Color::White) ? 8 : -8;
+    constexpr Bitboard START_RANK = rankBB((Us==Color::White) ? 1 : 6);
+    constexpr Bitboard PROMO_RANK = rankBB((Us==Color::White) ? 7 : 0);
+
+    const Bitboard own = bd.occ[(int)Us];
+    const Bitboard enemy = bd.occ[(int)Them];
+    const Bitboard all = own | enemy;
+    const Bitboard (&T)[7] = bd.pieces[(int)Them];
+    const Bitboard theirDiag = T[(int)PieceType::Bishop] | T[(int)PieceType::Queen];
+    const Bitboard theirOrth = T[(int)PieceType::Rook]   | T[(int)PieceType::Queen];
+    const int ksq = bd.findKing(Us);
+
+    // checkMask: squares a non-king move must land on (capture the checker or block it).
+    // A pinned piece may only move along the line through its king and pinner.
+    Bitboard checkers = bd.attackersTo(ksq, all) & enemy;
+    Bitboard checkMask = ~Bitboard(0);
+    if(checkers) checkMask = checkers | betweenBB(ksq, lsb(checkers));
+
+    Bitboard pinned = 0;
+    Bitboard snipers = ((rookAttacks(ksq, 0) & theirOrth) | (bishopAttacks(ksq, 0) & theirDiag));
+    while(snipers){
+        Bitboard blockers = betweenBB(ksq, popLsb(snipers)) & all;
+        if(blockers && !(blockers & (blockers-1))) pinned |= blockers & own;
+    }
+    auto allowed = [&](int from){
+        return (pinned & bit(from)) ? (checkMask & lineBB(ksq, from)) : checkMask;
+    };
+
+    // Sliders are looked up through the king's own square, so it can't hide behind itself.
+    auto kingSafe = [&](int to){
+        Bitboard o = all ^ bit(ksq);
+        return !(pawnAttacks(Us, to) & T[(int)PieceType::Pawn]) &&
+               !(knightAttacks(to) & T[(int)PieceType::Knight]) &&
+               !(kingAttacks(to) & T[(int)PieceType::King]) &&
+               !(bishopAttacks(to, o) & theirDiag) &&
+               !(rookAttacks(to, o) & theirOrth);
+    };
+
+    // In double check only the king can move. The generation order matches generate().
+    const bool doubleCheck = checkers & (checkers-1);
+    if(!doubleCheck){
+        Bitboard pawns = bd.pieces[(int)Us][(int)PieceType::Pawn] & fromMask;
+        while(pawns){
+            int from = popLsb(pawns);
+            Bitboard ok = allowed(from);
+            int one = from + UP;
+            if(!(all & bit(one))){
+                if(ok & bit(one)){
+                    if(bit(one) & PROMO_RANK) pushPromos(out, from, one, false);
+                    else pushMove(out, from, one);
+                }
+                int two = one + UP;
+                if((bit(from) & START_RANK) && !(all & bit(two)) && (ok & bit(two))) pushMove(out, from, two);
+            }
+
+            Bitboard caps = pawnAttacks(Us, from) & enemy & ok;
+            while(caps){
+                int to = popLsb(caps);
+                if(bit(to) & PROMO_RANK) pushPromos(out, from, to, true);
+                else pushMove(out, from, to, true);
+            }
+
+            // En passant removes two pieces from one line, which the pin mask can't see:
+            // replay the occupancy change and look for a slider hitting the king. Any other
+            // checker has to be the captured pawn itself.
+            if(bd.epSquare>=0 && (pawnAttacks(Us, from) & bit(bd.epSquare))){
+                int adj = bd.epSquare - UP;
+                if(bd.b[adj].t==PieceType::Pawn && bd.b[adj].c==Them && !(checkers & ~bit(adj) & ~(theirDiag|theirOrth))){
+                    Bitboard o = (all ^ bit(from) ^ bit(adj)) | bit(bd.epSquare);
+                    if(!(bishopAttacks(ksq, o) & theirDiag) && !(rookAttacks(ksq, o) & theirOrth))
+                        pushMove(out, from, bd.epSquare, true, true);
+                }
+            }
+        }
+
+        genPieceMoves<Us, PieceType::Knight>(bd, out, ~own, fromMask, allowed);
+        genPieceMoves<Us, PieceType::Bishop>(bd, out, ~own, fromMask, allowed);
+        genPieceMoves<Us, PieceType::Rook>  (bd, out, ~own, fromMask, allowed);
+        genPieceMoves<Us, PieceType::Queen> (bd, out, ~own, fromMask, allowed);
+    }
+
+    if(!(fromMask & bit(ksq))) return;
+    Bitboard targets = kingAttacks(ksq) & ~own;
+    while(targets){
+        int to = popLsb(targets);
+        if(kingSafe(to)) pushMove(out, ksq, to, (enemy & bit(to)) != 0);
+    }
+    if(!checkers) genCastlingFor<Us>(bd, out);
+}
+
+template<Color Us>
+void generateFor(const Board& bd, MoveList& out, GenType type){
+    switch(type){
+        case GenType::Captures: genPseudo<Us, GenType::Captures>(bd, out); break;
+        case GenType::Quiets:   genPseudo<Us, GenType::Quiets>(bd, out); break;
+        case GenType::All:      genPseudo<Us, GenType::All>(bd, out); break;
+        case GenType::Evasions: genLegalFor<Us>(bd, out, ~Bitboard(0)); break;
+    }
+}
+
+} // namespace
+
+void Board::generate(MoveList& out, GenType type) const {
+    if(stm==Color::White) generateFor<Color::White>(*this, out, type);
+    else generateFor<Color::Black>(*this, out, type);
+}
+
+void Board::genCastling(MoveList& out) const {
+    if(stm==Color::White) genCastlingFor<Color::White>(*this, out);
+    else genCastlingFor<Color::Black>(*this, out);
+}
+
+bool Board::isPseudoLegal(const Move& m) const {
+    if(m.from==m.to || m.from>63 || m.to>63) return false;
+    Piece p = b[m.from];
+    if(isNone(p) || p.c!=stm) return false;
+
+    if(m.isCastle){
+        if(p.t!=PieceType::King) return false;
+        MoveList cl;
+        genCastling(cl);
+        for(const auto& c : cl) if(c.to==m.to) return true;
+        return false;
+    }
+
+    Piece t = b[m.to];
+    if(!isNone(t) && t.c==stm) return false;
+    if(!m.isEnPassant && m.isCapture != !isNone(t)) return false;
+
+    if(p.t!=PieceType::Pawn){
+        if(m.isEnPassant || m.promo!=PieceType::None) return false;
+        return (pieceAttacks(p.t, stm, m.from, occupied()) & bit(m.to)) != 0;
+    }
+
+    int dir = (stm==Color::White) ? 8 : -8;
+    bool lastRank = (bit(m.to) & rankBB((stm==Color::White) ? 7 : 0)) != 0;
+    if(lastRank != (m.promo!=PieceType::None)) return false;
+    if(m.promo==PieceType::Pawn || m.promo==PieceType::King) return false;
+
+    if(m.isEnPassant){
+        if(!m.isCapture || int(m.to)!=epSquare || !(pawnAttacks(stm, m.from) & bit(m.to))) return false;
+        Piece adj = b[epSquare - dir];
+        return adj.t==PieceType::Pawn && adj.c!=stm;
+    }
+    if(m.isCapture) return (pawnAttacks(stm, m.from) & bit(m.to)) != 0;
+
+    if(int(m.to) == int(m.from) + dir) return true;   // target already known empty
+    int startRank = (stm==Color::White) ? 1 : 6;
+    return int(m.to) == int(m.from) + 2*dir && int(m.from)/8 == startRank &&
+           isNone(b[int(m.from) + dir]);
+}
+
+bool Board::seeGE(const Move& m, int threshold) const {
+    if(m.isCastle) return threshold <= 0;
+
+    const int from = m.from, to = m.to;
+    Bitboard o = occupied() ^ bit(from);
+    int gain = 0;
+    if(m.isEnPassant){
+        gain = pieceValue(PieceType::Pawn);
+        o ^= bit(to + ((stm==Color::White) ? -8 : 8));
+    } else if(m.isCapture){
+        gain = pieceValue(b[to].t);
+    }
+    PieceType onTarget = b[from].t;
+    if(m.promo!=PieceType::None){
+        gain += pieceValue(m.promo) - pieceValue(PieceType::Pawn);
+        onTarget = m.promo;
+    }
+
+    // swap is the balance if the opponent stops now (>= 0 means we're at the threshold).
+    int swap = gain - threshold;
+    if(swap < 0) return false;
+    swap = pieceValue(onTarget) - swap;
+    if(swap <= 0) return true;
+
+    const Bitboard diag = piecesOf(Color::White, PieceType::Bishop) | piecesOf(Color::Black, PieceType::Bishop)
+                        | piecesOf(Color::White, PieceType::Queen)  | piecesOf(Color::Black, PieceType::Queen);
+    const Bitboard orth = piecesOf(Color::White, PieceType::Rook)   | piecesOf(Color::Black, PieceType::Rook)
+                        | piecesOf(Color::White, PieceType::Queen)  | piecesOf(Color::Black, PieceType::Queen);
+
+    Bitboard attackers = attackersTo(to, o) & o;
+    Color side = stm;
+    bool res = true;
+    for(;;){
+        side = other(side);
+        Bitboard mine = attackers & occ[(int)side];
+        if(!mine) break;
+        res = !res;
+
+        int pt = (int)PieceType::Pawn;
+        while(!(mine & pieces[(int)side][pt])) pt++;
+
+        // A king may only recapture if the other side has nothing left on the square.
+        if(pt==(int)PieceType::King)
+            return (attackers & occ[(int)other(side)] & o) ? !res : res;
+
+        swap = pieceValue((PieceType)pt) - swap;
+        if(swap < (int)res) break;
+
+        o ^= bit(lsb(mine & pieces[(int)side][pt]));
+        // Removing a piece can uncover a slider behind it.
+        if(pt==(int)PieceType::Pawn || pt==(int)PieceType::Bishop || pt==(int)PieceType::Queen)
+            attackers |= bishopAttacks(to, o) & diag;
+        if(pt==(int)PieceType::Rook || pt==(int)PieceType::Queen)
+            attackers |= rookAttacks(to, o) & orth;
+        attackers &= o;
+    }
+    return res;
+}
+
+bool Board::makeMove(const Move& m, Undo& u){
+    u.m = m;
+    u.epSquare = epSquare;
+    u.castling = castling;
+    u.halfmoveClock = halfmoveClock;
+    u.hash = hash;
+    u.pawnKey = pawnKey;
+    u.captured = Piece{};
+
+    Piece moving = b[m.from];
+    if(isNone(moving)) return false;
+
+    bool resetHalf = (moving.t==PieceType::Pawn) || m.isCapture || m.isEnPassant;
+    halfmoveClock = resetHalf ? 0 : (halfmoveClock + 1);
+
+    if(z){
+        int oldEpF = (epSquare>=0) ? (epSquare%8) : 8;
+        hash ^= z->epFile[oldEpF];
+        hash ^= z->castling[castling & 0xF];
+        if(stm==Color::Black) hash ^= z->sideToMove;
+    }
+
+    epSquare = -1;
+
+    if(m.isEnPassant){
+        int dir = (moving.c==Color::White) ? -8 : 8;
+        int capSq = int(m.to) + dir;
+        u.captured = b[capSq];
+        if(z && !isNone(u.captured)){
+            int cc = (u.captured.c==Color::White)?0:1;
+            hash ^= z->psq[cc][(int)u.captured.t][capSq];
+            pawnKey ^= z->psq[cc][(int)u.captured.t][capSq];
+        }
+        if(!isNone(u.captured)) removePiece(capSq);
+    } else if(m.isCapture){
+        u.captured = b[m.to];
+        if(z && !isNone(u.captured)){
+            int cc = (u.captured.c==Color::White)?0:1;
+            hash ^= z->psq[cc][(int)u.captured.t][(int)m.to];
+            if(u.captured.t==PieceType::Pawn) pawnKey ^= z->psq[cc][(int)PieceType::Pawn][(int)m.to];
+        }
+        if(!isNone(u.captured)) removePiece(m.to);
+    }
+
+    if(z){
+        int mc = (moving.c==Color::White)?0:1;
+        hash ^= z->psq[mc][(int)moving.t][(int)m.from];
+        if(moving.t==PieceType::Pawn) pawnKey ^= z->psq[mc][(int)PieceType::Pawn][(int)m.from];
+    }
+
+    movePiece(m.from, m.to);
+
+    if(z){
+        int mc = (moving.c==Color::White)?0:1;
+        hash ^= z->psq[mc][(int)moving.t][(int)m.to];
+        if(moving.t==PieceType::Pawn && m.promo==PieceType::None) pawnKey ^= z->psq[mc][(int)PieceType::Pawn][(int)m.to];
+    }
+
+    if(m.promo != PieceType::None){
+        if(z){
+            int mc = (moving.c==Color::White)?0:1;
+            hash ^= z->psq[mc][(int)PieceType::Pawn][(int)m.to];
+            hash ^= z->psq[mc][(int)m.promo][(int)m.to];
+        }
+        removePiece(m.to);
+        putPiece(m.to, Piece{m.promo, moving.c});
+    }
+
+    if(m.isCastle){
+        if(moving.c==Color::White){
+            if(m.to==6){
+                Piece rook=b[7];
+                if(z){
+                    int rc=0;
+                    hash ^= z->psq[rc][(int)rook.t][7];
+                    hash ^= z->psq[rc][(int)rook.t][5];
+                }
+                movePiece(7, 5);
+            } else if(m.to==2){
+                Piece rook=b[0];
+                if(z){
+                    int rc=0;
+                    hash ^= z->psq[rc][(int)rook.t][0];
+                    hash ^= z->psq[rc][(int)rook.t][3];
+                }
+                movePiece(0, 3);
+            }
+        } else {
+            if(m.to==62){
+                Piece rook=b[63];
+                if(z){
+                    int rc=1;
+                    hash ^= z->psq[rc][(int)rook.t][63];
+                    hash ^= z->psq[rc][(int)rook.t][61];
+                }
+                movePiece(63, 61);
+            } else if(m.to==58){
+                Piece rook=b[56];
+                if(z){
+                    int rc=1;
+                    hash ^= z->psq[rc][(int)rook.t][56];
+                    hash ^= z->psq[rc][(int)rook.t][59];
+                }
+                movePiece(56, 59);
+            }
+        }
+    }
+
+    auto clearIfTouches = [&](int sq, u8 mask){
+        if(int(m.from)==sq || int(m.to)==sq) castling &= ~mask;
+    };
+    clearIfTouches(4,  0b0011);
+    clearIfTouches(0,  0b0010);
+    clearIfTouches(7,  0b0001);
+    clearIfTouches(60, 0b1100);
+    clearIfTouches(56, 0b1000);
+    clearIfTouches(63, 0b0100);
+
+    if(moving.t==PieceType::Pawn){
+        int fr = int(m.from)/8;
+        int tr = int(m.to)/8;
+        if(std::abs(tr - fr) == 2){
+            epSquare = (int(m.from) + int(m.to))/2;
+        }
+    }
+
+    stm = other(stm);
+    if(stm==Color::White) fullmoveNumber++;
+
+    if(nn){
+        NNUEAccumulator& a = nn->push();
+        auto dirty = [&](Piece pc, int from, int to){ a.dirty[a.dirtyCount++] = {pc, from, to}; };
+        if(m.promo==PieceType::None) dirty(moving, m.from, m.to);
+        else { dirty(moving, m.from, -1); dirty(Piece{m.promo, moving.c}, -1, m.to); }
+        if(!isNone(u.captured)) dirty(u.captured, m.isEnPassant ? int(m.to) + (moving.c==Color::White ? -8 : 8) : int(m.to), -1);
+        if(m.isCastle){
+            int rank = (moving.c==Color::White) ? 0 : 56;
+            bool kingSide = (m.to % 8)==6;
+            dirty(Piece{PieceType::Rook, moving.c}, rank + (kingSide ? 7 : 0), rank + (kingSide ? 5 : 3));
+        }
+    }
+
+    if(inCheck(other(stm))){
+        undoMove(u);
+        return false;
+    }
+
+    if(z){
+        int newEpF = (epSquare>=0) ? (epSquare%8) : 8;
+        hash ^= z->epFile[newEpF];
+        hash ^= z->castling[castling & 0xF];
+        if(stm==Color::Black) hash ^= z->sideToMove;
+    }
+
+    return true;
+}
+
+void Board::undoMove(const Undo& u){
+    const Move& m = u.m;
+    if(nn) nn->pop();
+
+    stm = other(stm);
+    if(stm==Color::Black) fullmoveNumber--;
+
+    epSquare = u.epSquare;
+    castling = u.castling;
+    halfmoveClock = u.halfmoveClock;
+    hash = u.hash;
+    pawnKey = u.pawnKey;
+
+    Piece moved = b[m.to];
+
+    if(m.isCastle){
+        if(moved.c==Color::White){
+            if(m.to==6) movePiece(5, 7);
+            else if(m.to==2) movePiece(3, 0);
+        } else {
+            if(m.to==62) movePiece(61, 63);
+            else if(m.to==58) movePiece(59, 56);
+        }
+    }
+
+    if(m.promo != PieceType::None){
+        removePiece(m.to);
+        putPiece(m.to, Piece{PieceType::Pawn, moved.c});
+    }
+
+    movePiece(m.to, m.from);
+
+    if(!isNone(u.captured)){
+        if(m.isEnPassant){
+            int dir = (moved.c==Color::White) ? -8 : 8;
+            putPiece(int(m.to) + dir, u.captured);
+        } else if(m.isCapture){
+            putPiece(m.to, u.captured);
+        }
+    }
+}
+
+void Board::makeNullMove(Undo& u){
+    u.m = Move{};
+    u.captured = Piece{};
+    u.epSquare = epSquare;
+    u.castling = castling;
+    u.halfmoveClock = halfmoveClock;
+    u.hash = hash;
+    u.pawnKey = pawnKey;
+
+    if(z){
+        hash ^= z->epFile[(epSquare>=0) ? (epSquare%8) : 8];
+        hash ^= z->epFile[8];
+        hash ^= z->sideToMove;
+    }
+    epSquare = -1;
+    halfmoveClock = 0;   // keeps repetition scans from reaching back across the pass
+    stm = other(stm);
+    if(nn) nn->push();
+}
+
+void Board::undoNullMove(const Undo& u){
+    if(nn) nn->pop();
+    stm = other(stm);
+    epSquare = u.epSquare;
+    halfmoveClock = u.halfmoveClock;
+    hash = u.hash;
+}
+
+void Board::genLegal(MoveList& out, Bitboard fromMask) const {
+    out.clear();
+    if(stm==Color::White) genLegalFor<Color::White>(*this, out, fromMask);
+    else genLegalFor<Color::Black>(*this, out, fromMask);
+}
+
+void Board::genLegalMoves(MoveList& legal) const {
+    genLegal(legal, ~Bitboard(0));
+}
+
+void Board::genLegalMovesFrom(int from, MoveList& out) const {
+    genLegal(out, bit(from));
+}
+
+bool Board::insufficientMaterial() const {
+    auto cnt = [&](int c, PieceType t){ return popcount(pieces[c][(int)t]); };
+    int wOther = cnt(0,PieceType::Pawn) + cnt(0,PieceType::Rook) + cnt(0,PieceType::Queen);
+    int bOther = cnt(1,PieceType::Pawn) + cnt(1,PieceType::Rook) + cnt(1,PieceType::Queen);
+    if(wOther>0 || bOther>0) return false;
+
+    int wB=cnt(0,PieceType::Bishop), wN=cnt(0,PieceType::Knight);
+    int bB=cnt(1,PieceType::Bishop), bN=cnt(1,PieceType::Knight);
+    int wMinor=wB+wN, bMinor=bB+bN;
+    if(wMinor==0 && bMinor==0) return true;
+    if(wMinor==1 && bMinor==0 && (wB==1 || wN==1)) return true;
+    if(bMinor==1 && wMinor==0 && (bB==1 || bN==1)) return true;
+    if(wMinor==1 && bMinor==1 && wB==1 && bB==1) return true;
+    return false;
+}
+
+std::optional<Move> moveFromUCI(Board& bd, const std::string& uci){
+    MoveList legal;
+    bd.genLegalMoves(legal);
+    for(const Move& m : legal){
+        if(moveToUCI(m)==uci) return m;
+    }
+    return std::nullopt;
+}
+
+std::string moveToSAN(const Board& bd, const Move& m, const MoveList& legal){
+    static const char LETTER[] = " PNBRQK";
+    std::string s;
+    PieceType pt = bd.at(m.from).t;
+    Square from = indexToSq(m.from), to = indexToSq(m.to);
+
+    if(m.isCastle){
+        s = (to.file==6) ? "O-O" : "O-O-O";
+    } else {
+        if(pt==PieceType::Pawn){
+            if(m.isCapture) s += char('a'+from.file);
+        } else {
+            s += LETTER[(int)pt];
+            // Disambiguate by file, then rank, then both, against same-type moves to the same square.
+            bool clash=false, sameFile=false, sameRank=false;
+            for(const Move& o : legal){
+                if(o.to!=m.to || o.from==m.from || bd.at(o.from).t!=pt) continue;
+                clash = true;
+                if(indexToSq(o.from).file==from.file) sameFile = true;
+                if(indexToSq(o.from).rank==from.rank) sameRank = true;
+            }
+            if(clash){
+                if(!sameFile) s += char('a'+from.file);
+                else if(!sameRank) s += char('1'+from.rank);
+                else s += sqName(from);
+            }
+        }
+        if(m.isCapture) s += 'x';
+        s += sqName(to);
+        if(m.promo!=PieceType::None){ s += '='; s += LETTER[(int)m.promo]; }
+    }
+
+    Board after = bd;
+    after.nn = nullptr;   // a scratch copy must not push onto the caller's accumulator stack
+    Undo u{};
+    after.makeMove(m, u);
+    if(after.inCheck(after.stm)){
+        MoveList replies;
+        after.genLegalMoves(replies);
+        s += replies.empty() ? '#' : '+';
+    }
+    return s;
+}
+
+std::optional<Move> moveFromSAN(Board& bd, const std::string& san){
+    std::string want = san;
+    while(!want.empty() && std::strchr("+#!?", want.back())) want.pop_back();
+    if(want=="0-0") want = "O-O";
+    else if(want=="0-0-0") want = "O-O-O";
+    MoveList legal;
+    bd.genLegalMoves(legal);
+    for(const Move& m : legal){
+        std::string s = moveToSAN(bd, m, legal);
+        while(!s.empty() && (s.back()=='+' || s.back()=='#')) s.pop_back();
+        if(s==want || moveToUCI(m)==want) return m;
+    }
+    return std::nullopt;
+}
@@ -0,0 +1,203 @@
+// engine/board.h
+#pragma once
+
+#include "bitboard.h"
+#include "psqt.h"
+#include "zobrist.h"
+
+#include <array>
+#include <optional>
+#include <string>
+
+struct NNUEStack;
+
+inline const char* START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+// ======================== Board ========================
+struct Board {
+    // Bitboards are the primary representation; the mailbox is kept in sync as a
+    // piece-on-square lookup side-table (GUI, move flags, captured piece lookup).
+    std::array<Piece, 64> b{};
+    Bitboard pieces[2][7]{};    // [color][pieceType], index 0 (None) unused
+    Bitboard occ[2]{};          // per-colour occupancy
+    Color stm = Color::White;
+
+    int epSquare = -1;          // en passant target square index or -1
+    u8 castling = 0b1111;       // 1=WK,2=WQ,4=BK,8=BQ
+    int halfmoveClock = 0;      // 50-move heuristic
+    int fullmoveNumber = 1;     // only for FEN output; starts at 1, incremented after Black moves
+    u64 hash = 0;
+    u64 pawnKey = 0;            // Zobrist of pawns only (keys the pawn hash table)
+
+    // Incremental evaluation accumulators (white minus black), maintained by the
+    // mutation primitives so evaluate() reads them in O(1).
+    int material = 0;
+    int pstMg = 0;
+    int pstEg = 0;
+    int phase = 0;              // unclamped: N,B=1 R=2 Q=4
+
+    const Zobrist* z = nullptr;
+    NNUEStack* nn = nullptr;    // if set, makeMove/undoMove keep this accumulator stack in step
+
+    void clear(){
+        for(auto& p : b) p = Piece{};
+        for(auto& c : pieces) for(auto& bb : c) bb = 0;
+        occ[0] = occ[1] = 0;
+        stm = Color::White;
+        epSquare = -1;
+        castling = 0b1111;
+        halfmoveClock = 0;
+        fullmoveNumber = 1;
+        hash = 0;
+        pawnKey = 0;
+        material = pstMg = pstEg = phase = 0;
+    }
+
+    void reset();
+
+    // Loads a FEN (the move counters are optional) and recomputes the hash. Returns false
+    // and leaves the board untouched if the string is malformed.
+    bool setFen(const std::string& fen);
+
+    // The position as FEN, all six fields; setFen(fen()) restores it exactly.
+    std::string fen() const;
+
+    Piece at(int idx) const { return b[idx]; }
+
+    Bitboard occupied() const { return occ[0] | occ[1]; }
+    Bitboard piecesOf(Color c, PieceType t) const { return pieces[(int)c][(int)t]; }
+
+    // Board mutation primitives: keep mailbox, bitboards and eval accumulators in sync
+    // (hash is handled by the caller).
+    void putPiece(int sq, Piece p){
+        int c = (int)p.c, pt = (int)p.t;
+        Bitboard m = bit(sq);
+        b[sq] = p;
+        pieces[c][pt] |= m;
+        occ[c] |= m;
+        material += (c==0 ? 1 : -1) * pieceValue(p.t);
+        pstMg += PSQ.mg[c][pt][sq];
+        pstEg += PSQ.eg[c][pt][sq];
+        phase += PHASE_WEIGHT[pt];
+    }
+    void removePiece(int sq){
+        Piece p = b[sq];
+        int c = (int)p.c, pt = (int)p.t;
+        Bitboard m = bit(sq);
+        pieces[c][pt] ^= m;
+        occ[c] ^= m;
+        b[sq] = Piece{};
+        material -= (c==0 ? 1 : -1) * pieceValue(p.t);
+        pstMg -= PSQ.mg[c][pt][sq];
+        pstEg -= PSQ.eg[c][pt][sq];
+        phase -= PHASE_WEIGHT[pt];
+    }
+    void movePiece(int from, int to){
+        Piece p = b[from];
+        int c = (int)p.c, pt = (int)p.t;
+        Bitboard m = bit(from) | bit(to);
+        pieces[c][pt] ^= m;
+        occ[c] ^= m;
+        b[to] = p;
+        b[from] = Piece{};
+        pstMg += PSQ.mg[c][pt][to] - PSQ.mg[c][pt][from];
+        pstEg += PSQ.eg[c][pt][to] - PSQ.eg[c][pt][from];
+    }
+
+    void setZobrist(const Zobrist* zz){
+        z = zz;
+        recomputeHash();
+    }
+
+    void recomputeHash();
+
+    int findKing(Color c) const {
+        Bitboard k = pieces[(int)c][(int)PieceType::King];
+        return k ? lsb(k) : -1;
+    }
+
+    // All pieces of either colour attacking sq, given occupancy o.
+    Bitboard attackersTo(int sq, Bitboard o) const {
+        const Bitboard (&W)[7] = pieces[0];
+        const Bitboard (&B)[7] = pieces[1];
+        Bitboard diag = W[(int)PieceType::Bishop] | W[(int)PieceType::Queen] | B[(int)PieceType::Bishop] | B[(int)PieceType::Queen];
+        Bitboard orth = W[(int)PieceType::Rook]   | W[(int)PieceType::Queen] | B[(int)PieceType::Rook]   | B[(int)PieceType::Queen];
+        return (pawnAttacks(Color::Black, sq) & W[(int)PieceType::Pawn])
+             | (pawnAttacks(Color::White, sq) & B[(int)PieceType::Pawn])
+             | (knightAttacks(sq) & (W[(int)PieceType::Knight] | B[(int)PieceType::Knight]))
+             | (kingAttacks(sq)   & (W[(int)PieceType::King]   | B[(int)PieceType::King]))
+             | (bishopAttacks(sq, o) & diag)
+             | (rookAttacks(sq, o) & orth);
+    }
+
+    bool isSquareAttacked(int sq, Color by) const {
+        const Bitboard (&P)[7] = pieces[(int)by];
+        if(pawnAttacks(other(by), sq) & P[(int)PieceType::Pawn]) return true;
+        if(knightAttacks(sq) & P[(int)PieceType::Knight]) return true;
+        if(kingAttacks(sq) & P[(int)PieceType::King]) return true;
+
+        Bitboard o = occupied();
+        Bitboard diag = P[(int)PieceType::Bishop] | P[(int)PieceType::Queen];
+        if(diag && (bishopAttacks(sq, o) & diag)) return true;
+        Bitboard orth = P[(int)PieceType::Rook] | P[(int)PieceType::Queen];
+        if(orth && (rookAttacks(sq, o) & orth)) return true;
+
+        return false;
+    }
+
+    bool inCheck(Color c) const {
+        int k = findKing(c);
+        if(k<0) return false;
+        return isSquareAttacked(k, other(c));
+    }
+
+    void genPseudoMoves(MoveList& out) const {
+        out.clear();
+        generate(out, GenType::All);
+    }
+
+    // Appends moves of the requested kind to out: pseudo-legal captures (en passant and all
+    // promotions included), quiets or both, or, in check, the legal evasions.
+    void generate(MoveList& out, GenType type) const;
+
+    void genCastling(MoveList& out) const;
+
+    // True if m could have been produced by generate() in this position. Used to
+    // validate TT and killer moves, which may come from a different position.
+    bool isPseudoLegal(const Move& m) const;
+
+    // Static exchange evaluation: true if the capture sequence started by m on its target
+    // square, with both sides always recapturing with their least valuable attacker,
+    // nets at least threshold centipawns for the mover. Pins are ignored.
+    bool seeGE(const Move& m, int threshold) const;
+
+    bool makeMove(const Move& m, Undo& u);
+    void undoMove(const Undo& u);
+
+    // Passes the turn (null-move pruning). Never call it while in check.
+    void makeNullMove(Undo& u);
+    void undoNullMove(const Undo& u);
+
+    // Anything besides king and pawns: null-move pruning is unsafe without it (zugzwang).
+    bool hasNonPawnMaterial(Color c) const {
+        return (occ[(int)c] ^ piecesOf(c, PieceType::Pawn) ^ piecesOf(c, PieceType::King)) != 0;
+    }
+
+    // Fully legal moves, generated directly from the checkers and pinned pieces of the
+    // position (no make/undo per move). Same order as generate(GenType::All).
+    void genLegalMoves(MoveList& legal) const;
+    void genLegalMovesFrom(int from, MoveList& out) const;
+    void genLegal(MoveList& out, Bitboard fromMask) const;
+
+    bool insufficientMaterial() const;
+};
+
+// Finds the legal move written in UCI long algebraic notation (e2e4, e7e8q).
+std::optional<Move> moveFromUCI(Board& bd, const std::string& uci);
+
+// Standard algebraic notation (Nbd2, exd8=Q+, O-O) of m, one of bd's legal moves.
+std::string moveToSAN(const Board& bd, const Move& m, const MoveList& legal);
+
+// Finds the legal move written in SAN; check marks and !/? annotations are optional, and a
+// UCI move is accepted too (EPD files use both).
+std::optional<Move> moveFromSAN(Board& bd, const std::string& san);
@@ -0,0 +1,47 @@
+// engine/book.h  (Polyglot opening book: memory-mapped .bin lookup)
+#pragma once
+
+#include "board.h"
+
+#include <cstddef>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+struct BookMove {
+    Move move;
+    int weight = 0;
+};
+
+// A Polyglot book is a sorted array of 16-byte big-endian entries (key, move, weight,
+// learn). On POSIX systems the file is mapped read-only, so nothing is read up front and
+// lookups only touch the pages a binary search visits; elsewhere it is read into memory.
+// Keys use the fixed Random64 table of the format, built in.
+struct PolyglotBook {
+    static constexpr u64 START_KEY = 0x463B96181691FC9CULL;
+
+    PolyglotBook() = default;
+    ~PolyglotBook(){ close(); }
+    PolyglotBook(const PolyglotBook&) = delete;
+    PolyglotBook& operator=(const PolyglotBook&) = delete;
+
+    // False (and the book stays closed) if the file is missing or malformed.
+    bool open(const std::string& bookPath);
+    void close();
+    bool isOpen() const { return data != nullptr; }
+
+    // Polyglot hash of bd (independent of Board::hash).
+    static u64 key(const Board& bd);
+
+    // Book moves for bd that are legal in it, in file order.
+    std::vector<BookMove> probe(const Board& bd) const;
+
+    // A book move chosen with probability proportional to its weight.
+    std::optional<Move> pick(const Board& bd, std::mt19937_64& rng) const;
+
+    const unsigned char* data = nullptr;
+    size_t mapSize = 0;
+    size_t entries = 0;
+    std::vector<unsigned char> buffer;   // the file contents where it can't be mapped
+};
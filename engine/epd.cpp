@@ -0,0 +1,205 @@
+// engine/epd.cpp
+#include "epd.h"
+#include "search.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+// Splits the operations after the position ("bm Qg6; id \"WAC.001\";") into opcode and
+// operands. Quoted operands are one operand and may contain ';'.
+static void parseOperations(const std::string& s, EpdPosition& p){
+    std::vector<std::string> words;
+    std::string word;
+    bool quoted = false, wasQuoted = false;
+    auto finishOp = [&](){
+        if(words.empty()) return;
+        const std::string& op = words[0];
+        std::vector<std::string> args(words.begin() + 1, words.end());
+        if(op=="bm") p.bm = args;
+        else if(op=="am") p.am = args;
+        else if(op=="id" && !args.empty()) p.id = args[0];
+        else if(op=="c0" && args.size()==1 && args[0].find('=')!=std::string::npos){
+            std::istringstream in(args[0]);
+            std::string item;
+            while(std::getline(in, item, ',')){
+                size_t eq = item.find('=');
+                if(eq==std::string::npos) continue;
+                std::string mv = item.substr(0, eq);
+                mv.erase(std::remove_if(mv.begin(), mv.end(), [](unsigned char c){ return std::isspace(c); }), mv.end());
+                p.points.emplace_back(mv, std::atoi(item.c_str() + eq + 1));
+            }
+        }
+        words.clear();
+    };
+    auto finishWord = [&](){
+        if(!word.empty() || wasQuoted) words.push_back(word);
+        word.clear();
+        wasQuoted = false;
+    };
+    for(char c : s){
+        if(quoted){
+            if(c=='"') quoted = false;
+            else word += c;
+        } else if(c=='"'){
+            quoted = wasQuoted = true;
+        } else if(c==';'){
+            finishWord();
+            finishOp();
+        } else if(std::isspace((unsigned char)c)){
+            finishWord();
+        } else {
+            word += c;
+        }
+    }
+    finishWord();
+    finishOp();
+}
+
+std::vector<EpdPosition> loadEpd(const std::string& path){
+    std::vector<EpdPosition> out;
+    std::ifstream in(path);
+    std::string line;
+    while(std::getline(in, line)){
+        std::istringstream is(line);
+        std::string f[4];
+        if(!(is >> f[0] >> f[1] >> f[2] >> f[3]) || f[0][0]=='#') continue;
+        EpdPosition p;
+        p.fen = f[0] + " " + f[1] + " " + f[2] + " " + f[3];
+
+        // A plain FEN has the move counters where EPD has its operations.
+        std::string rest;
+        std::getline(is, rest);
+        std::istringstream counters(rest);
+        std::string half, full;
+        if(counters >> half >> full && std::all_of(half.begin(), half.end(), ::isdigit) && std::all_of(full.begin(), full.end(), ::isdigit)){
+            p.fen += " " + half + " " + full;
+            std::getline(counters, rest);
+        }
+        Board bd;
+        if(!bd.setFen(p.fen)) continue;
+        parseOperations(rest, p);
+        out.push_back(std::move(p));
+    }
+    return out;
+}
+
+namespace {
+
+bool sameMove(const Move& a, const Move& b){
+    return a.from==b.from && a.to==b.to && a.promo==b.promo;
+}
+
+// True if m is one of the moves written in list (unknown or illegal entries never match).
+bool listed(Board& bd, const std::vector<std::string>& list, const Move& m){
+    for(const std::string& s : list){
+        std::optional<Move> x = moveFromSAN(bd, s);
+        if(x && sameMove(*x, m)) return true;
+    }
+    return false;
+}
+
+struct EpdLine {
+    int index = 0;
+    Move best{};
+    int score = 0;
+    int depth = 0;
+    u64 nodes = 0;
+    int verdict = -1;             // 1 solved, 0 not, -1 nothing to check
+    int points = -1;              // -1 without a c0 list
+};
+
+EpdLine analyse(SearchPool& pool, const Zobrist& zob, const EpdConfig& cfg, const EpdPosition& p, int index){
+    EpdLine r;
+    r.index = index;
+    Board bd;
+    bd.setZobrist(&zob);
+    bd.setFen(p.fen);
+
+    pool.newGame();
+    pool.gameHistory.clear();
+    TimeBudget budget = (cfg.moveTimeMs > 0) ? TimeBudget::fixed(cfg.moveTimeMs) : TimeBudget{};
+    int maxDepth = (cfg.depth > 0) ? std::min(cfg.depth, MAX_PLY-1) : MAX_PLY-1;
+    r.best = pool.search(bd, maxDepth, budget);
+    r.score = pool.stats.bestScore;
+    r.depth = pool.stats.depthReached;
+    r.nodes = pool.stats.nodes + pool.stats.qnodes;
+
+    if(!p.bm.empty() || !p.am.empty())
+        r.verdict = (p.bm.empty() || listed(bd, p.bm, r.best)) && !listed(bd, p.am, r.best);
+    if(!p.points.empty()){
+        r.points = 0;
+        for(const auto& pt : p.points){
+            std::optional<Move> x = moveFromSAN(bd, pt.first);
+            if(x && sameMove(*x, r.best)) r.points = std::max(r.points, pt.second);
+        }
+    }
+    return r;
+}
+
+} // namespace
+
+EpdResult runEpd(const EpdConfig& cfg, const std::vector<EpdPosition>& positions, std::ostream& log){
+    Zobrist zob;
+    EpdResult r;
+    std::mutex outMutex;
+    std::atomic<int> next{0};
+    const int count = (int)positions.size();
+    auto t0 = std::chrono::steady_clock::now();
+
+    auto work = [&](){
+        SearchPool pool(1);
+        pool.tt.resizeMB((size_t)cfg.hashMB);
+        for(int i = next++; i < count; i = next++){
+            const EpdPosition& p = positions[i];
+            EpdLine l = analyse(pool, zob, cfg, p, i);
+
+            Board bd;
+            bd.setFen(p.fen);
+            MoveList legal;
+            bd.genLegalMoves(legal);
+            std::string best = (l.best.from==l.best.to) ? std::string("(none)") : moveToSAN(bd, l.best, legal);
+
+            std::ostringstream oss;
+            oss << (i+1) << "/" << count;
+            if(!p.id.empty()) oss << " " << p.id;
+            oss << " " << best;
+            if(l.verdict >= 0){
+                oss << (l.verdict ? " ok" : " FAIL");
+                for(const std::string& m : p.bm) oss << " bm " << m;
+                for(const std::string& m : p.am) oss << " am " << m;
+            }
+            if(l.points >= 0) oss << " points " << l.points;
+            oss << " score " << l.score << " depth " << l.depth << " nodes " << l.nodes << "\n";
+
+            std::lock_guard<std::mutex> lock(outMutex);
+            r.positions++;
+            r.nodes += l.nodes;
+            if(l.verdict >= 0){ r.scored++; r.solved += l.verdict; }
+            if(l.points >= 0){
+                r.points += l.points;
+                int top = 0;
+                for(const auto& pt : p.points) top = std::max(top, pt.second);
+                r.maxPoints += top;
+            }
+            log << oss.str();
+            log.flush();
+        }
+    };
+
+    int threads = std::clamp(cfg.threads, 1, std::max(1, count));
+    std::vector<std::thread> pool;
+    for(int t=1;t<threads;t++) pool.emplace_back(work);
+    work();
+    for(auto& t : pool) t.join();
+
+    r.timeMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t0).count();
+    return r;
+}
@@ -0,0 +1,42 @@
+// engine/epd.h  (EPD test suites: batch analysis with best/avoid-move scoring)
+#pragma once
+
+#include "types.h"
+
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct EpdPosition {
+    std::string fen;
+    std::string id;                                   // "id" operation, may be empty
+    std::vector<std::string> bm, am;                  // best / avoid moves as written (SAN or UCI)
+    std::vector<std::pair<std::string, int>> points;  // STS-style c0 "Qd2=10, Qe2=5": move and score
+};
+
+struct EpdConfig {
+    int threads = 1;              // positions analysed at a time; each worker owns a single-threaded pool and TT
+    int hashMB = 16;              // per worker
+    int depth = 0;                // per-position limits; 0 = unused
+    int moveTimeMs = 0;
+};
+
+struct EpdResult {
+    int positions = 0;
+    int scored = 0;               // positions with bm or am
+    int solved = 0;
+    int points = 0;               // STS points, out of maxPoints (positions with a c0 list)
+    int maxPoints = 0;
+    u64 nodes = 0;
+    long long timeMs = 0;
+};
+
+// Reads one EPD (or FEN) per line; positions that don't parse are skipped. Blank lines and
+// lines starting with '#' are ignored.
+std::vector<EpdPosition> loadEpd(const std::string& path);
+
+// Searches every position from an empty TT, cfg.threads at a time, and writes one line per
+// position to log as it finishes (best move, verdict, score, depth, nodes). A position is
+// solved when the move found is one of bm and none of am.
+EpdResult runEpd(const EpdConfig& cfg, const std::vector<EpdPosition>& positions, std::ostream& log);
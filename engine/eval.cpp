@@ -0,0 +1,179 @@
+// engine/eval.cpp
+#include "eval.h"
+
+#include <cstdlib>
+
+// ======================== Pawn structure ========================
+struct PawnMasks {
+    Bitboard passed[2][64]{};   // squares in front of a pawn (own + adjacent files) that must be pawn-free
+
+    PawnMasks(){
+        for(int sq=0;sq<64;sq++){
+            int f=sq%8, r=sq/8;
+            Bitboard files = fileBB(f) | (f>0 ? fileBB(f-1) : 0) | (f<7 ? fileBB(f+1) : 0);
+            for(int rr=r+1; rr<8; rr++) passed[0][sq] |= files & rankBB(rr);
+            for(int rr=r-1; rr>=0; rr--) passed[1][sq] |= files & rankBB(rr);
+        }
+    }
+};
+static const PawnMasks PAWN_MASKS;
+
+// Pawn-structure term counts per colour; the score is their dot product with the weights
+// in evalparams.h, so the tuner can read the same counts.
+struct PawnCounts {
+    int doubled[2]{};
+    int isolated[2]{};
+};
+
+static void countPawnTerms(const Board& bd, PawnCounts& pc, Bitboard passed[2]){
+    const Bitboard pawns[2] = { bd.pieces[0][(int)PieceType::Pawn], bd.pieces[1][(int)PieceType::Pawn] };
+    for(int c=0;c<2;c++){
+        int onFile[8]{};
+        for(int f=0;f<8;f++) onFile[f] = popcount(pawns[c] & fileBB(f));
+        for(int f=0;f<8;f++){
+            if(onFile[f]>=2) pc.doubled[c] += onFile[f]-1;
+            bool left = (f>0 && onFile[f-1]>0);
+            bool right= (f<7 && onFile[f+1]>0);
+            if(onFile[f]>0 && !left && !right) pc.isolated[c]++;
+        }
+
+        passed[c] = 0;
+        Bitboard bb = pawns[c];
+        while(bb){
+            int sq = popLsb(bb);
+            if(!(PAWN_MASKS.passed[c][sq] & pawns[c^1])) passed[c] |= bit(sq);
+        }
+    }
+}
+
+static void computePawnEntry(const Board& bd, PawnEntry& e){
+    PawnCounts pc;
+    countPawnTerms(bd, pc, e.passed);
+    int pawnStruct = 0;
+    for(int c=0;c<2;c++){
+        int sign = (c==0) ? 1 : -1;
+        pawnStruct -= sign * (DOUBLED_PAWN*pc.doubled[c] + ISOLATED_PAWN*pc.isolated[c]);
+    }
+    e.score = pawnStruct;
+}
+
+// ======================== Evaluation (PST + extras) ========================
+EvalConfig evalConfig;
+
+// Squares reached by knights, bishops, rooks and queens, excluding squares held by
+// their own side, White minus Black. Read straight from the attack tables; no board copy
+// or move list.
+static int mobilityCount(const Board& bd){
+    const Bitboard all = bd.occupied();
+    int count[2]{};
+    for(int c=0;c<2;c++){
+        Bitboard notOwn = ~bd.occ[c];
+        for(int pt=(int)PieceType::Knight; pt<=(int)PieceType::Queen; pt++){
+            Bitboard bb = bd.pieces[c][pt];
+            while(bb){
+                int sq = popLsb(bb);
+                count[c] += popcount(pieceAttacks((PieceType)pt, (Color)c, sq, all) & notOwn);
+            }
+        }
+    }
+    return count[0] - count[1];
+}
+
+// KING_CENTRE bucket of a king on the d-f files: its distance from the nearer edge rank
+// (0-2), or -1 if it is off those files or further in.
+static int kingCentreBucket(int kIdx){
+    if(kIdx<0 || std::abs(kIdx%8 - 4) > 1) return -1;
+    int r = std::min(kIdx/8, 7 - kIdx/8);
+    return (r<=2) ? r : -1;
+}
+
+int evaluate(const Board& bd, PawnHashTable* pawnTable){
+    if(evalConfig.nnue && nnueLoaded()) return nnueEvaluate(bd);
+
+    int phase = std::clamp(bd.phase, 0, 24);
+    bool endgameKing = (phase <= 8);
+
+    int material = bd.material;
+    int pst = endgameKing ? bd.pstEg : bd.pstMg;
+
+    int whiteBishops = popcount(bd.pieces[0][(int)PieceType::Bishop]);
+    int blackBishops = popcount(bd.pieces[1][(int)PieceType::Bishop]);
+
+    int bishopPair = 0;
+    if(whiteBishops>=2) bishopPair += BISHOP_PAIR;
+    if(blackBishops>=2) bishopPair -= BISHOP_PAIR;
+
+    int pawnStruct = 0;
+    if(pawnTable && bd.z){
+        PawnEntry& e = pawnTable->probe(bd.pawnKey);
+        if(e.key != bd.pawnKey){
+            computePawnEntry(bd, e);
+            e.key = bd.pawnKey;
+        }
+        pawnStruct = e.score;
+    } else {
+        PawnEntry e;
+        computePawnEntry(bd, e);
+        pawnStruct = e.score;
+    }
+
+    int mobility = evalConfig.mobility ? mobilityCount(bd) * MOBILITY : 0;
+
+    int kingSafety=0;
+    if(!endgameKing){
+        int wb = kingCentreBucket(bd.findKing(Color::White));
+        int bb = kingCentreBucket(bd.findKing(Color::Black));
+        if(wb>=0) kingSafety -= KING_CENTRE[wb];
+        if(bb>=0) kingSafety += KING_CENTRE[bb];
+
+        bool wCanCastle = (bd.castling & 0b0011);
+        bool bCanCastle = (bd.castling & 0b1100);
+        if(!wCanCastle) kingSafety -= NO_CASTLING;
+        if(!bCanCastle) kingSafety += NO_CASTLING;
+    }
+
+    int scoreWhite = material + pst + bishopPair + pawnStruct + mobility + kingSafety;
+    return (bd.stm==Color::White) ? scoreWhite : -scoreWhite;
+}
+
+void evalTrace(const Board& bd, std::vector<EvalCoef>& out){
+    out.clear();
+    int coef[EP_COUNT]{};
+    bool endgameKing = std::clamp(bd.phase, 0, 24) <= 8;
+
+    for(int c=0;c<2;c++){
+        int sign = (c==0) ? 1 : -1;
+        for(int pt=(int)PieceType::Pawn; pt<=(int)PieceType::King; pt++){
+            int table = (pt==(int)PieceType::King) ? (endgameKing ? 6 : 5) : pt-1;
+            Bitboard bb = bd.pieces[c][pt];
+            while(bb){
+                int sq = popLsb(bb);
+                coef[EP_PIECE + pt] += sign;
+                coef[EP_PST + table*64 + (c==0 ? sq : mirrorIndex(sq))] += sign;
+            }
+        }
+    }
+
+    if(popcount(bd.pieces[0][(int)PieceType::Bishop])>=2) coef[EP_BISHOP_PAIR]++;
+    if(popcount(bd.pieces[1][(int)PieceType::Bishop])>=2) coef[EP_BISHOP_PAIR]--;
+
+    PawnCounts pc;
+    Bitboard passed[2];
+    countPawnTerms(bd, pc, passed);
+    coef[EP_DOUBLED] = pc.doubled[1] - pc.doubled[0];     // penalties: weight is subtracted
+    coef[EP_ISOLATED] = pc.isolated[1] - pc.isolated[0];
+
+    if(evalConfig.mobility) coef[EP_MOBILITY] = mobilityCount(bd);
+
+    if(!endgameKing){
+        int wb = kingCentreBucket(bd.findKing(Color::White));
+        int bb = kingCentreBucket(bd.findKing(Color::Black));
+        if(wb>=0) coef[EP_KING_CENTRE + wb]--;
+        if(bb>=0) coef[EP_KING_CENTRE + bb]++;
+        if(!(bd.castling & 0b0011)) coef[EP_NO_CASTLING]--;
+        if(!(bd.castling & 0b1100)) coef[EP_NO_CASTLING]++;
+    }
+
+    for(int i=0;i<EP_COUNT;i++)
+        if(coef[i]) out.push_back(EvalCoef{u16(i), int16_t(coef[i])});
+}
@@ -0,0 +1,58 @@
+// engine/eval.h  (static evaluation and the pawn hash)
+#pragma once
+
+#include "board.h"
+#include "nnue.h"
+
+#include <algorithm>
+#include <vector>
+
+// ======================== Pawn hash ========================
+// Pawn terms depend only on the pawn placement, which changes rarely inside a search,
+// so they are cached per pawn configuration keyed by Board::pawnKey.
+struct PawnEntry {
+    u64 key=0;
+    int score=0;            // white-positive doubled/isolated total
+    Bitboard passed[2]{};   // passed pawns per colour, for king/piece terms that use them
+};
+
+struct PawnHashTable {
+    std::vector<PawnEntry> table;
+
+    explicit PawnHashTable(size_t entries = 16384) : table(entries) {}   // power of two
+
+    PawnEntry& probe(u64 key){ return table[size_t(key) & (table.size()-1)]; }
+    void clear(){ std::fill(table.begin(), table.end(), PawnEntry{}); }
+};
+
+// ======================== Evaluation (PST + extras) ========================
+// Individually switchable evaluation terms, so each one's cost and value can be measured.
+struct EvalConfig {
+    bool mobility = true;
+    bool nnue = true;       // use the network instead of the terms below once one is loaded
+};
+extern EvalConfig evalConfig;
+
+// Side-to-move relative score in centipawns. Pass a pawn table to cache pawn terms.
+int evaluate(const Board& bd, PawnHashTable* pawnTable = nullptr);
+
+// ======================== Tuning ========================
+// Every weight in evalparams.h has an index. evalTrace lists how often each one counts in
+// bd (White minus Black), so the hand-written evaluate is sum(coef * weight) from White's view.
+enum EvalParam : int {
+    EP_PIECE = 0,                    // + piece type
+    EP_PST = EP_PIECE + 7,           // + table*64 + square; tables P N B R Q K(mg) K(eg)
+    EP_BISHOP_PAIR = EP_PST + 7*64,
+    EP_DOUBLED,
+    EP_ISOLATED,
+    EP_MOBILITY,
+    EP_KING_CENTRE,                  // + bucket
+    EP_NO_CASTLING = EP_KING_CENTRE + 3,
+    EP_COUNT
+};
+
+struct EvalCoef {
+    u16 param;
+    int16_t coef;
+};
+void evalTrace(const Board& bd, std::vector<EvalCoef>& out);
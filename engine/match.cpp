@@ -0,0 +1,239 @@
+// engine/match.cpp
+#include "match.h"
+#include "search.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <thread>
+
+std::vector<std::string> loadOpenings(const std::string& path){
+    std::vector<std::string> out;
+    std::ifstream in(path);
+    std::string line;
+    while(std::getline(in, line)){
+        std::istringstream is(line);
+        std::string f[6];
+        int n = 0;
+        while(n < 6 && is >> f[n]) n++;
+        if(n < 4 || f[0][0]=='#') continue;
+        bool counters = n==6 && std::isdigit((unsigned char)f[4][0]) && std::isdigit((unsigned char)f[5][0]);
+        std::string fen = f[0] + " " + f[1] + " " + f[2] + " " + f[3] + (counters ? " " + f[4] + " " + f[5] : " 0 1");
+        Board bd;
+        if(bd.setFen(fen)) out.push_back(fen);
+    }
+    return out;
+}
+
+static std::string jsonEscape(const std::string& s){
+    std::string out;
+    for(char c : s){
+        if(c=='"' || c=='\\') out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+namespace {
+
+struct GameRecord {
+    int number = 0;
+    std::string fen;              // opening position ("" = startpos); random plies are in moves
+    std::vector<Move> moves;
+    std::vector<std::string> san;
+    std::vector<int> scores;      // search score of each move, from the mover's side
+    std::string result;           // "1-0", "0-1", "1/2-1/2"
+    std::string reason;
+    u64 nodes = 0;
+};
+
+// One worker: a private pool (and so a private TT) that plays both sides of its games.
+struct MatchWorker {
+    const MatchConfig& cfg;
+    const Zobrist& zob;
+    SearchPool pool{1};
+
+    MatchWorker(const MatchConfig& c, const Zobrist& z) : cfg(c), zob(z) {
+        pool.tt.resizeMB((size_t)cfg.hashMB);
+        pool.nodeLimit = cfg.nodes;
+    }
+
+    // Game states the position reached by the moves so far can end in, or "" to play on.
+    // history holds the hashes since the last irreversible move, current position excluded.
+    static std::string gameOver(const Board& bd, const MoveList& legal, const std::vector<u64>& history, std::string& result){
+        if(legal.empty()){
+            if(bd.inCheck(bd.stm)){
+                result = (bd.stm==Color::White) ? "0-1" : "1-0";
+                return "checkmate";
+            }
+            result = "1/2-1/2";
+            return "stalemate";
+        }
+        result = "1/2-1/2";
+        if(bd.halfmoveClock >= 100) return "fifty moves";
+        if(bd.insufficientMaterial()) return "insufficient material";
+        int seen = 0;
+        for(size_t i = history.size() % 2; i < history.size(); i += 2)   // same side to move only
+            if(history[i]==bd.hash) seen++;
+        if(seen >= 2) return "threefold repetition";
+        return "";
+    }
+
+    GameRecord play(int number){
+        GameRecord g;
+        g.number = number;
+
+        if(!cfg.openings.empty()) g.fen = cfg.openings[number % cfg.openings.size()];
+        Board bd;
+        bd.setZobrist(&zob);
+        if(g.fen.empty()) bd.reset();
+        else bd.setFen(g.fen);
+
+        std::vector<u64> history;
+        auto makeGameMove = [&](const Move& m){
+            history.push_back(bd.hash);
+            Undo u{};
+            bd.makeMove(m, u);
+            if(bd.halfmoveClock==0) history.clear();
+        };
+
+        // Random plies are part of the opening: they go into the PGN moves but get no score.
+        std::mt19937_64 rng(u64(number) * 0x9E3779B97F4A7C15ULL + 1);
+        pool.newGame();
+        MoveList legal;
+        for(int i=0;i<cfg.randomPlies;i++){
+            bd.genLegalMoves(legal);
+            if(legal.empty()) break;
+            Move m = legal[int(rng() % u64(legal.size()))];
+            g.san.push_back(moveToSAN(bd, m, legal));
+            g.moves.push_back(m);
+            g.scores.push_back(0);
+            makeGameMove(m);
+        }
+
+        TimeBudget budget = (cfg.moveTimeMs > 0) ? TimeBudget::fixed(cfg.moveTimeMs) : TimeBudget{};
+        int maxDepth = (cfg.depth > 0) ? std::min(cfg.depth, MAX_PLY-1) : MAX_PLY-1;
+        for(;;){
+            bd.genLegalMoves(legal);
+            g.reason = gameOver(bd, legal, history, g.result);
+            if(!g.reason.empty()) break;
+            if((int)g.moves.size() >= cfg.maxPlies){
+                g.result = "1/2-1/2";
+                g.reason = "adjudicated: move limit";
+                break;
+            }
+
+            pool.gameHistory = history;
+            Move m = pool.search(bd, maxDepth, budget);
+            g.nodes += pool.stats.nodes + pool.stats.qnodes;
+            g.san.push_back(moveToSAN(bd, m, legal));
+            g.moves.push_back(m);
+            g.scores.push_back(pool.stats.bestScore);
+            makeGameMove(m);
+        }
+        return g;
+    }
+};
+
+// PGN date of today, "YYYY.MM.DD". Called with the output lock held (std::localtime is
+// not reentrant).
+std::string pgnDate(){
+    std::time_t now = std::time(nullptr);
+    const std::tm* t = std::localtime(&now);
+    char buf[16];
+    if(!t || !std::strftime(buf, sizeof(buf), "%Y.%m.%d", t)) return "????.??.??";
+    return buf;
+}
+
+// Tags in Seven Tag Roster order, then the extras.
+void writePGN(std::ostream& os, const GameRecord& g){
+    os << "[Event \"Orryx self-play\"]\n"
+       << "[Site \"?\"]\n"
+       << "[Date \"" << pgnDate() << "\"]\n"
+       << "[Round \"" << (g.number + 1) << "\"]\n"
+       << "[White \"Orryx\"]\n"
+       << "[Black \"Orryx\"]\n"
+       << "[Result \"" << g.result << "\"]\n"
+       << "[Termination \"" << g.reason << "\"]\n";
+    bool blackFirst = false;
+    int moveNo = 1;
+    if(!g.fen.empty()){
+        os << "[SetUp \"1\"]\n[FEN \"" << g.fen << "\"]\n";
+        std::istringstream is(g.fen);
+        std::string f[6];
+        for(auto& p : f) is >> p;
+        blackFirst = (f[1]=="b");
+        moveNo = std::max(1, std::atoi(f[5].c_str()));
+    }
+    os << "\n";
+
+    std::string line;
+    for(size_t i=0;i<g.san.size();i++){
+        bool black = ((i % 2)==1) != blackFirst;
+        std::string tok;
+        if(!black) tok = std::to_string(moveNo) + ". ";
+        else if(i==0) tok = std::to_string(moveNo) + "... ";
+        tok += g.san[i];
+        if(black) moveNo++;
+        if(line.size() + tok.size() + 1 > 79){ os << line << "\n"; line.clear(); }
+        line += (line.empty() ? "" : " ") + tok;
+    }
+    if(line.size() + g.result.size() + 1 > 79){ os << line << "\n"; line.clear(); }
+    os << line << (line.empty() ? "" : " ") << g.result << "\n\n";
+}
+
+void writeJSON(std::ostream& os, const GameRecord& g){
+    os << "{\"game\":" << (g.number + 1)
+       << ",\"fen\":\"" << jsonEscape(g.fen.empty() ? "startpos" : g.fen) << "\""
+       << ",\"result\":\"" << g.result << "\""
+       << ",\"termination\":\"" << jsonEscape(g.reason) << "\""
+       << ",\"plies\":" << g.moves.size()
+       << ",\"nodes\":" << g.nodes
+       << ",\"moves\":[";
+    for(size_t i=0;i<g.moves.size();i++) os << (i ? "," : "") << "\"" << moveToUCI(g.moves[i]) << "\"";
+    os << "],\"scores\":[";
+    for(size_t i=0;i<g.scores.size();i++) os << (i ? "," : "") << g.scores[i];
+    os << "]}\n";
+}
+
+} // namespace
+
+MatchResult runMatch(const MatchConfig& cfg, std::ostream* pgn, std::ostream* json){
+    Zobrist zob;
+    MatchResult r;
+    std::mutex outMutex;
+    std::atomic<int> next{0};
+    auto t0 = std::chrono::steady_clock::now();
+
+    auto work = [&](){
+        MatchWorker w(cfg, zob);
+        for(int i = next++; i < cfg.games; i = next++){
+            GameRecord g = w.play(i);
+            std::lock_guard<std::mutex> lock(outMutex);
+            r.games++;
+            r.nodes += g.nodes;
+            if(g.result=="1-0") r.whiteWins++;
+            else if(g.result=="0-1") r.blackWins++;
+            else r.draws++;
+            if(pgn){ writePGN(*pgn, g); pgn->flush(); }
+            if(json){ writeJSON(*json, g); json->flush(); }
+        }
+    };
+
+    int threads = std::clamp(cfg.threads, 1, std::max(1, cfg.games));
+    std::vector<std::thread> pool;
+    for(int t=1;t<threads;t++) pool.emplace_back(work);
+    work();
+    for(auto& t : pool) t.join();
+
+    r.timeMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t0).count();
+    return r;
+}
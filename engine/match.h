@@ -0,0 +1,38 @@
+// engine/match.h  (headless self-play: many concurrent games, PGN + JSON output)
+#pragma once
+
+#include "types.h"
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+struct MatchConfig {
+    int games = 100;
+    int threads = 1;              // concurrent games; each worker owns a single-threaded pool and TT
+    int hashMB = 16;              // per worker
+    int depth = 0;                // per-move limits; any combination, 0 = unused
+    u64 nodes = 0;
+    int moveTimeMs = 0;
+    int maxPlies = 400;           // longer games are adjudicated as draws
+    int randomPlies = 0;          // random legal moves played after the opening, seeded by game number
+    std::vector<std::string> openings;   // FENs; game i starts from openings[i % size], or startpos if empty
+};
+
+struct MatchResult {
+    int games = 0;
+    int whiteWins = 0;
+    int blackWins = 0;
+    int draws = 0;
+    u64 nodes = 0;
+    long long timeMs = 0;
+};
+
+// Reads one FEN or EPD position per line (extra EPD operations are dropped, missing move
+// counters become "0 1"). Blank lines and lines starting with '#' are skipped.
+std::vector<std::string> loadOpenings(const std::string& path);
+
+// Plays cfg.games games of the engine against itself, cfg.threads at a time. Every finished
+// game is written whole to pgn and, as one JSON object per line, to json (either may be
+// null); the writes are serialized, so games appear in the order they finish.
+MatchResult runMatch(const MatchConfig& cfg, std::ostream* pgn, std::ostream* json);
@@ -0,0 +1,301 @@
+// engine/nnue.cpp
+#include "nnue.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+constexpr u32 NNUE_VERSION = 0x7AF32F16u;
+constexpr int L1 = 32, L2 = 32;
+constexpr int WEIGHT_SHIFT = 6;     // dense layer outputs are fixed point with 6 fraction bits
+constexpr int OUTPUT_SCALE = 16;    // final output / 16 = internal units
+constexpr int NET_PAWN = 208;       // internal units per pawn in the original nets
+
+struct Network {
+    std::vector<int16_t> ftBias, ftWeight;   // [NNUE_HALF], [NNUE_INPUTS][NNUE_HALF]
+    alignas(32) int32_t b1[L1];
+    alignas(32) int8_t  w1[L1][2*NNUE_HALF];
+    alignas(32) int32_t b2[L2];
+    alignas(32) int8_t  w2[L2][L1];
+    int32_t b3;
+    alignas(32) int8_t  w3[L2];
+    std::string description;
+};
+
+Network net;
+bool loaded = false;
+
+// ---------------- features ----------------
+// Both perspectives see the board from their own side: black's squares are rotated by 180
+// degrees, and "own" pieces always come first within each piece type.
+inline int orient(int persp, int sq){ return sq ^ (persp ? 63 : 0); }
+
+inline int featureIndex(int persp, int ksq, Piece pc, int sq){
+    int kind = ((int)pc.t - 1) * 2 + ((int)pc.c == persp ? 0 : 1);
+    return orient(persp, sq) + 1 + kind*64 + 641*orient(persp, ksq);
+}
+
+// ---------------- kernels ----------------
+inline void addFeature(int16_t* acc, int f){
+    const int16_t* w = &net.ftWeight[size_t(f) * NNUE_HALF];
+#if defined(__AVX2__)
+    for(int i=0;i<NNUE_HALF;i+=16){
+        __m256i a = _mm256_load_si256((const __m256i*)(acc+i));
+        _mm256_store_si256((__m256i*)(acc+i), _mm256_add_epi16(a, _mm256_loadu_si256((const __m256i*)(w+i))));
+    }
+#elif defined(__ARM_NEON)
+    for(int i=0;i<NNUE_HALF;i+=8) vst1q_s16(acc+i, vaddq_s16(vld1q_s16(acc+i), vld1q_s16(w+i)));
+#else
+    for(int i=0;i<NNUE_HALF;i++) acc[i] += w[i];
+#endif
+}
+
+inline void subFeature(int16_t* acc, int f){
+    const int16_t* w = &net.ftWeight[size_t(f) * NNUE_HALF];
+#if defined(__AVX2__)
+    for(int i=0;i<NNUE_HALF;i+=16){
+        __m256i a = _mm256_load_si256((const __m256i*)(acc+i));
+        _mm256_store_si256((__m256i*)(acc+i), _mm256_sub_epi16(a, _mm256_loadu_si256((const __m256i*)(w+i))));
+    }
+#elif defined(__ARM_NEON)
+    for(int i=0;i<NNUE_HALF;i+=8) vst1q_s16(acc+i, vsubq_s16(vld1q_s16(acc+i), vld1q_s16(w+i)));
+#else
+    for(int i=0;i<NNUE_HALF;i++) acc[i] -= w[i];
+#endif
+}
+
+// out[i] = bias[i] + dot(w[i], in) over N inputs (a multiple of 32). Inputs are 0..127, so
+// the paired u8*i8 products can't saturate int16 and every path gives the same result.
+template<int N>
+inline void affine(const uint8_t* in, const int8_t (*w)[N], const int32_t* bias, int32_t* out, int outputs){
+    int o = 0;
+#if defined(__AVX2__)
+    const __m256i ones = _mm256_set1_epi16(1);
+    auto dot = [&](__m256i x, const int8_t* row){
+        return _mm256_madd_epi16(_mm256_maddubs_epi16(x, _mm256_load_si256((const __m256i*)row)), ones);
+    };
+    // Four rows at a time share the input loads and the final horizontal sums.
+    for(; o+4 <= outputs; o+=4){
+        __m256i s0 = _mm256_setzero_si256(), s1 = s0, s2 = s0, s3 = s0;
+        for(int j=0;j<N;j+=32){
+            __m256i x = _mm256_load_si256((const __m256i*)(in+j));
+            s0 = _mm256_add_epi32(s0, dot(x, w[o]+j));
+            s1 = _mm256_add_epi32(s1, dot(x, w[o+1]+j));
+            s2 = _mm256_add_epi32(s2, dot(x, w[o+2]+j));
+            s3 = _mm256_add_epi32(s3, dot(x, w[o+3]+j));
+        }
+        s0 = _mm256_hadd_epi32(_mm256_hadd_epi32(s0, s1), _mm256_hadd_epi32(s2, s3));
+        __m128i r = _mm_add_epi32(_mm256_castsi256_si128(s0), _mm256_extracti128_si256(s0, 1));
+        _mm_storeu_si128((__m128i*)(out+o), _mm_add_epi32(r, _mm_loadu_si128((const __m128i*)(bias+o))));
+    }
+    for(; o<outputs; o++){
+        __m256i sum = _mm256_setzero_si256();
+        for(int j=0;j<N;j+=32) sum = _mm256_add_epi32(sum, dot(_mm256_load_si256((const __m256i*)(in+j)), w[o]+j));
+        __m128i r = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+        r = _mm_add_epi32(r, _mm_shuffle_epi32(r, 0x4E));
+        r = _mm_add_epi32(r, _mm_shuffle_epi32(r, 0xB1));
+        out[o] = bias[o] + _mm_cvtsi128_si32(r);
+    }
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    for(; o<outputs; o++){
+        int32x4_t sum = vdupq_n_s32(0);
+        for(int j=0;j<N;j+=16){
+            int8x16_t x = vreinterpretq_s8_u8(vld1q_u8(in+j));
+            int8x16_t ww = vld1q_s8(w[o]+j);
+            int16x8_t p = vmull_s8(vget_low_s8(x), vget_low_s8(ww));
+            p = vmlal_s8(p, vget_high_s8(x), vget_high_s8(ww));
+            sum = vpadalq_s16(sum, p);
+        }
+        out[o] = bias[o] + vaddvq_s32(sum);
+    }
+#else
+    for(; o<outputs; o++){
+        int32_t s = bias[o];
+        for(int j=0;j<N;j++) s += int32_t(in[j]) * w[o][j];
+        out[o] = s;
+    }
+#endif
+}
+
+inline void clippedRelu(const int32_t* in, uint8_t* out, int n){
+    for(int i=0;i<n;i++) out[i] = (uint8_t)std::clamp(in[i] >> WEIGHT_SHIFT, 0, 127);
+}
+
+// ---------------- accumulator ----------------
+void refresh(const Board& bd, NNUEAccumulator& a, int persp){
+    int16_t* acc = a.v[persp];
+    std::memcpy(acc, net.ftBias.data(), sizeof(a.v[persp]));
+    int ksq = bd.findKing((Color)persp);
+    Bitboard all = bd.occupied() & ~(bd.pieces[0][(int)PieceType::King] | bd.pieces[1][(int)PieceType::King]);
+    while(all){
+        int sq = popLsb(all);
+        addFeature(acc, featureIndex(persp, ksq, bd.at(sq), sq));
+    }
+    a.computed[persp] = true;
+}
+
+bool kingMoved(const NNUEAccumulator& a, int persp){
+    for(int i=0;i<a.dirtyCount;i++)
+        if(a.dirty[i].pc.t==PieceType::King && (int)a.dirty[i].pc.c==persp) return true;
+    return false;
+}
+
+// Walks back to the nearest computed ply and replays the changes from there; a move of
+// this side's king changes every feature, so crossing one means a refresh instead.
+void update(const Board& bd, NNUEStack& s, int persp){
+    NNUEAccumulator* st = s.st.data();
+    int t = s.top, j = t;
+    while(!st[j].computed[persp]){
+        if(j==0 || kingMoved(st[j], persp)){ refresh(bd, st[t], persp); return; }
+        j--;
+    }
+    int ksq = bd.findKing((Color)persp);
+    for(int k=j+1;k<=t;k++){
+        NNUEAccumulator& a = st[k];
+        std::memcpy(a.v[persp], st[k-1].v[persp], sizeof(a.v[persp]));
+        for(int i=0;i<a.dirtyCount;i++){
+            const NNUEAccumulator::DirtyPiece& d = a.dirty[i];
+            if(d.pc.t==PieceType::King) continue;   // kings are not features
+            if(d.from >= 0) subFeature(a.v[persp], featureIndex(persp, ksq, d.pc, d.from));
+            if(d.to >= 0) addFeature(a.v[persp], featureIndex(persp, ksq, d.pc, d.to));
+        }
+        a.computed[persp] = true;
+    }
+}
+
+int propagate(const NNUEAccumulator& a, Color stm){
+    alignas(32) uint8_t in[2*NNUE_HALF];
+    const int16_t* sides[2] = { a.v[(int)stm], a.v[(int)other(stm)] };
+    for(int h=0;h<2;h++){
+#if defined(__AVX2__)
+        // packs saturates to -128..127 but interleaves 128-bit lanes; the permute undoes that
+        const __m256i zero = _mm256_setzero_si256();
+        for(int i=0;i<NNUE_HALF;i+=32){
+            __m256i lo = _mm256_load_si256((const __m256i*)(sides[h]+i));
+            __m256i hi = _mm256_load_si256((const __m256i*)(sides[h]+i+16));
+            __m256i packed = _mm256_max_epi8(_mm256_packs_epi16(lo, hi), zero);
+            _mm256_store_si256((__m256i*)(in + h*NNUE_HALF + i), _mm256_permute4x64_epi64(packed, 0xD8));
+        }
+#elif defined(__ARM_NEON)
+        for(int i=0;i<NNUE_HALF;i+=8){
+            int8x8_t packed = vqmovn_s16(vld1q_s16(sides[h]+i));
+            vst1_u8(in + h*NNUE_HALF + i, vreinterpret_u8_s8(vmax_s8(packed, vdup_n_s8(0))));
+        }
+#else
+        for(int i=0;i<NNUE_HALF;i++) in[h*NNUE_HALF + i] = (uint8_t)std::clamp<int>(sides[h][i], 0, 127);
+#endif
+    }
+
+    alignas(32) int32_t o1[L1], o2[L2], o3;
+    alignas(32) uint8_t h1[L1], h2[L2];
+    affine<2*NNUE_HALF>(in, net.w1, net.b1, o1, L1);
+    clippedRelu(o1, h1, L1);
+    affine<L1>(h1, net.w2, net.b2, o2, L2);
+    clippedRelu(o2, h2, L2);
+    affine<L2>(h2, &net.w3, &net.b3, &o3, 1);
+    return o3 * 100 / (OUTPUT_SCALE * NET_PAWN);
+}
+
+// ---------------- loading ----------------
+struct Reader {
+    const char* p;
+    const char* end;
+    bool ok = true;
+
+    template<class T> void read(T* out, size_t n){
+        size_t bytes = n * sizeof(T);
+        if(size_t(end - p) < bytes){ ok = false; return; }
+        std::memcpy(out, p, bytes);   // little-endian, like the files
+        p += bytes;
+    }
+    u32 u32v(){ u32 v = 0; read(&v, 1); return v; }
+};
+
+bool parse(const char* data, size_t size){
+    Reader r{data, data + size};
+    if(r.u32v() != NNUE_VERSION) return false;
+    r.u32v();                                   // network hash
+    u32 descLen = r.u32v();
+    if(!r.ok || descLen > size) return false;
+    std::string desc(descLen, '\0');
+    r.read(&desc[0], descLen);
+
+    Network n;
+    n.ftBias.resize(NNUE_HALF);
+    n.ftWeight.resize(size_t(NNUE_INPUTS) * NNUE_HALF);
+    r.u32v();                                   // feature transformer hash
+    r.read(n.ftBias.data(), n.ftBias.size());
+    r.read(n.ftWeight.data(), n.ftWeight.size());
+    r.u32v();                                   // dense layers hash
+    r.read(n.b1, L1);  r.read(&n.w1[0][0], sizeof(n.w1));
+    r.read(n.b2, L2);  r.read(&n.w2[0][0], sizeof(n.w2));
+    r.read(&n.b3, 1);  r.read(n.w3, L2);
+    if(!r.ok || r.p != r.end) return false;     // wrong architecture
+
+    n.description = desc;
+    net = std::move(n);
+    loaded = true;
+    return true;
+}
+
+} // namespace
+
+#ifdef ORRYX_NNUE_EMBED
+// The net is assembled straight into the binary; ORRYX_NNUE_EMBED is its (quoted) path.
+#if defined(__APPLE__)
+#define NNUE_SECTION ".const_data\n"
+#define NNUE_SYM "_"
+#else
+#define NNUE_SECTION ".section .rodata\n"
+#define NNUE_SYM ""
+#endif
+asm(NNUE_SECTION
+    ".balign 64\n"
+    ".globl " NNUE_SYM "orryxEmbeddedNet\n"
+    NNUE_SYM "orryxEmbeddedNet:\n"
+    ".incbin \"" ORRYX_NNUE_EMBED "\"\n"
+    ".globl " NNUE_SYM "orryxEmbeddedNetEnd\n"
+    NNUE_SYM "orryxEmbeddedNetEnd:\n"
+    ".text\n");
+extern "C" const char orryxEmbeddedNet[];
+extern "C" const char orryxEmbeddedNetEnd[];
+
+[[maybe_unused]] static const bool EMBEDDED_NET_LOADED = parse(orryxEmbeddedNet, size_t(orryxEmbeddedNetEnd - orryxEmbeddedNet));
+#endif
+
+bool nnueLoad(const std::string& path){
+    if(path.empty()){
+        loaded = false;
+        net = Network{};
+        return true;
+    }
+    std::ifstream in(path, std::ios::binary);
+    if(!in) return false;
+    std::vector<char> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    return parse(data.data(), data.size());
+}
+
+bool nnueLoaded(){ return loaded; }
+const std::string& nnueDescription(){ return net.description; }
+
+int nnueEvaluate(const Board& bd){
+    if(bd.nn){
+        NNUEStack& s = *bd.nn;
+        NNUEAccumulator& a = s.st[s.top];
+        for(int c=0;c<2;c++) if(!a.computed[c]) update(bd, s, c);
+        return propagate(a, bd.stm);
+    }
+    NNUEAccumulator a;
+    refresh(bd, a, 0);
+    refresh(bd, a, 1);
+    return propagate(a, bd.stm);
+}
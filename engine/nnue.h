@@ -0,0 +1,59 @@
+// engine/nnue.h  (HalfKP neural network evaluation with an incremental accumulator)
+#pragma once
+
+#include "board.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Network shape: HalfKP(friendly king, piece, square) -> 2x256 -> 32 -> 32 -> 1. The file
+// format is the one of the original Stockfish HalfKP nets ("halfkp_256x2-32-32"), so those
+// nets load as they are.
+constexpr int NNUE_HALF = 256;
+constexpr int NNUE_INPUTS = 64 * 641;   // king square x (1 + 10 piece kinds x 64 squares)
+
+// One ply of the accumulator stack. dirty lists the pieces the move into this ply changed
+// (from/to = -1 when the piece appeared/disappeared); v[c] is valid only once computed[c].
+struct NNUEAccumulator {
+    struct DirtyPiece { Piece pc; int from, to; };
+
+    alignas(32) int16_t v[2][NNUE_HALF];
+    bool computed[2] = {false, false};
+    DirtyPiece dirty[3];
+    int dirtyCount = 0;
+};
+
+// Per-thread stack, one entry per ply: Board::makeMove pushes (recording the changed
+// pieces), undoMove pops. Accumulators are brought up to date lazily by evaluate, from the
+// nearest computed ancestor, so plies that are never evaluated cost only the push.
+struct NNUEStack {
+    std::vector<NNUEAccumulator> st = std::vector<NNUEAccumulator>(256);
+    int top = 0;
+
+    // Starts a new root; its accumulator is rebuilt on the first evaluation.
+    void reset(){
+        top = 0;
+        st[0].computed[0] = st[0].computed[1] = false;
+        st[0].dirtyCount = 0;
+    }
+    NNUEAccumulator& push(){
+        if(++top == (int)st.size()) st.resize(st.size() * 2);
+        NNUEAccumulator& a = st[top];
+        a.computed[0] = a.computed[1] = false;
+        a.dirtyCount = 0;
+        return a;
+    }
+    void pop(){ top--; }
+};
+
+// Loads a network file; on failure the previous network (if any) stays. An empty path
+// unloads it. Not while a search is running. A net embedded at build time (NNUE_FILE in
+// scripts/build_engine.sh) is loaded at startup.
+bool nnueLoad(const std::string& path);
+bool nnueLoaded();
+const std::string& nnueDescription();
+
+// Side-to-move relative score in centipawns. Uses and updates bd.nn when it is set,
+// otherwise builds the accumulator from scratch.
+int nnueEvaluate(const Board& bd);
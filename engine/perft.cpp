@@ -0,0 +1,87 @@
+// engine/perft.cpp
+#include "perft.h"
+
+#include <algorithm>
+#include <thread>
+
+// Depth is folded into the key so the same position at different depths gets its own slot.
+static u64 perftKey(u64 key, int depth){
+    return key ^ (u64(depth) * 0x9E3779B97F4A7C15ULL);
+}
+
+void PerftTable::resizeMB(size_t mb){
+    if(mb==0){ table.reset(); mask = 0; return; }
+    size_t n = std::max<size_t>(1, mb*1024ull*1024ull / sizeof(Entry));
+    size_t p = 1;
+    while(p*2 <= n) p <<= 1;
+    table.reset(new Entry[p]);
+    mask = p-1;
+}
+
+bool PerftTable::probe(u64 key, int depth, u64& nodes) const {
+    u64 k = perftKey(key, depth);
+    const Entry& e = table[size_t(k) & mask];
+    u64 n = e.nodes.load(std::memory_order_relaxed);
+    u64 c = e.check.load(std::memory_order_relaxed);
+    if((c ^ n) != k || n==0) return false;
+    nodes = n;
+    return true;
+}
+
+void PerftTable::store(u64 key, int depth, u64 nodes){
+    u64 k = perftKey(key, depth);
+    Entry& e = table[size_t(k) & mask];
+    e.nodes.store(nodes, std::memory_order_relaxed);
+    e.check.store(k ^ nodes, std::memory_order_relaxed);
+}
+
+u64 perft(Board& bd, int depth, PerftTable* tt){
+    if(depth==0) return 1;
+
+    MoveList moves;
+    bd.genLegalMoves(moves);
+    if(depth==1) return (u64)moves.size();
+
+    bool hashed = tt && tt->enabled() && bd.z;
+    u64 cached = 0;
+    if(hashed && tt->probe(bd.hash, depth, cached)) return cached;
+
+    u64 nodes = 0;
+    for(const Move& m : moves){
+        Undo u{};
+        bd.makeMove(m, u);
+        nodes += perft(bd, depth-1, tt);
+        bd.undoMove(u);
+    }
+
+    if(hashed) tt->store(bd.hash, depth, nodes);
+    return nodes;
+}
+
+std::vector<DivideEntry> perftDivide(const Board& bd, int depth, int threads, PerftTable* tt){
+    Board root = bd;
+    MoveList moves;
+    root.genLegalMoves(moves);
+
+    std::vector<DivideEntry> out(moves.size());
+    for(int i=0;i<moves.size();i++) out[i].move = moves[i];
+    if(depth<=0) return out;
+
+    std::atomic<int> next{0};
+    auto work = [&](){
+        Board b = root;
+        for(int i = next++; i < (int)out.size(); i = next++){
+            Undo u{};
+            b.makeMove(out[i].move, u);
+            out[i].nodes = perft(b, depth-1, tt);
+            b.undoMove(u);
+        }
+    };
+
+    threads = std::clamp(threads, 1, std::max(1, (int)out.size()));
+    std::vector<std::thread> pool;
+    for(int t=1;t<threads;t++) pool.emplace_back(work);
+    work();
+    for(auto& t : pool) t.join();
+    return out;
+}
@@ -0,0 +1,38 @@
+// engine/perft.h  (move generator node counting: perft / divide)
+#pragma once
+
+#include "board.h"
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Optional perft cache keyed on Board::hash and the remaining depth. Same lock-free
+// xor-check layout as the search TT, so threads splitting the root can share it.
+struct PerftTable {
+    struct Entry {
+        std::atomic<u64> check{0};   // key ^ nodes
+        std::atomic<u64> nodes{0};
+    };
+    std::unique_ptr<Entry[]> table;
+    size_t mask = 0;
+
+    void resizeMB(size_t mb);
+    bool enabled() const { return table != nullptr; }
+    bool probe(u64 key, int depth, u64& nodes) const;
+    void store(u64 key, int depth, u64 nodes);
+};
+
+// Leaf nodes at the given depth. Counts the legal moves at the last ply instead of
+// playing them (bulk counting).
+u64 perft(Board& bd, int depth, PerftTable* tt = nullptr);
+
+struct DivideEntry {
+    Move move;
+    u64 nodes = 0;
+};
+
+// Per-root-move counts in generation order. Root moves are handed out to `threads`
+// workers, each on its own copy of the board.
+std::vector<DivideEntry> perftDivide(const Board& bd, int depth, int threads = 1, PerftTable* tt = nullptr);
@@ -0,0 +1,29 @@
+// engine/psqt.cpp
+#include "psqt.h"
+#include "evalparams.h"
+
+int pstScore(PieceType t, int idxWhitePerspective, bool endgameKing){
+    switch(t){
+        case PieceType::Pawn: return PST_PAWN[idxWhitePerspective];
+        case PieceType::Knight: return PST_KNIGHT[idxWhitePerspective];
+        case PieceType::Bishop: return PST_BISHOP[idxWhitePerspective];
+        case PieceType::Rook: return PST_ROOK[idxWhitePerspective];
+        case PieceType::Queen: return PST_QUEEN[idxWhitePerspective];
+        case PieceType::King: return endgameKing ? PST_KING_EG[idxWhitePerspective] : PST_KING_MG[idxWhitePerspective];
+        default: return 0;
+    }
+}
+
+PsqTables::PsqTables(){
+    for(int c=0;c<2;c++){
+        int sign = (c==0) ? 1 : -1;
+        for(int pt=(int)PieceType::Pawn; pt<=(int)PieceType::King; pt++){
+            for(int sq=0;sq<64;sq++){
+                int idxW = (c==0) ? sq : mirrorIndex(sq);
+                mg[c][pt][sq] = sign * pstScore((PieceType)pt, idxW, false);
+                eg[c][pt][sq] = sign * pstScore((PieceType)pt, idxW, true);
+            }
+        }
+    }
+}
+const PsqTables PSQ;
@@ -0,0 +1,25 @@
+// engine/psqt.h  (piece-square tables)
+#pragma once
+
+#include "types.h"
+
+inline int mirrorIndex(int idx){
+    int f = idx%8, r=idx/8;
+    int mr = 7-r;
+    return mr*8 + f;
+}
+
+// Value of a piece of type t on a square, seen from White (mirror the index for Black).
+int pstScore(PieceType t, int idxWhitePerspective, bool endgameKing);
+
+inline constexpr int PHASE_WEIGHT[7] = { 0, 0, 1, 1, 2, 4, 0 };   // None, P, N, B, R, Q, K
+
+// Signed (white-positive) per-square values used by Board's incremental accumulators.
+// mg uses the midgame king table, eg the endgame one; all other pieces share one table.
+struct PsqTables {
+    int mg[2][7][64]{};
+    int eg[2][7][64]{};
+
+    PsqTables();
+};
+extern const PsqTables PSQ;
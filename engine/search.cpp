@@ -0,0 +1,840 @@
+// engine/search.cpp
+#include "search.h"
+#include "syzygy.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdlib>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+// ======================== Instrumentation ========================
+#ifdef ORRYX_STATS
+// Adds the lifetime of the scope to a nanosecond total.
+struct ProfileTimer {
+    u64& total;
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    explicit ProfileTimer(u64& t) : total(t) {}
+    ~ProfileTimer(){
+        total += (u64)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count();
+    }
+};
+#define STAT_INC(ctx, field) ((ctx).stats.profile.field++)
+#define STAT_TIME(ctx, field) ProfileTimer profileTimer_((ctx).stats.profile.field)
+#else
+#define STAT_INC(ctx, field) ((void)0)
+#define STAT_TIME(ctx, field) ((void)0)
+#endif
+
+static bool sameMove(const Move& a, const Move& b){
+    return a.from==b.from && a.to==b.to && a.promo==b.promo && a.isCastle==b.isCastle && a.isEnPassant==b.isEnPassant;
+}
+
+static int mvvLvaScore(const Board& bd, const Move& m){
+    Piece a = bd.at(m.from);
+    int attacker = pieceValue(a.t);
+    int victim = 0;
+    if(m.isEnPassant){
+        victim = pieceValue(PieceType::Pawn);
+    } else if(m.isCapture){
+        Piece v = bd.at(m.to);
+        victim = pieceValue(v.t);
+    }
+    return victim*10 - attacker;
+}
+
+static int scoreMove(const Board& bd, SearchContext& ctx, const Move& m, const Move& ttMove, int ply){
+    if(ttMove.from==m.from && ttMove.to==m.to && ttMove.promo==m.promo) return 1000000;
+
+    if(m.isCapture || m.isEnPassant){
+        if(!bd.seeGE(m, 0)) return -100000 + mvvLvaScore(bd, m);   // losing: after the quiets
+        return 100000 + mvvLvaScore(bd, m);
+    }
+
+    if(ply<MAX_PLY){
+        if(sameMove(m, ctx.killer[ply][0])) return 90000;
+        if(sameMove(m, ctx.killer[ply][1])) return 80000;
+    }
+
+    int side = (bd.stm==Color::White)?0:1;
+    return ctx.history[side][m.from][m.to];
+}
+
+static bool isTactical(const Move& m){
+    return m.isCapture || m.isEnPassant || m.promo!=PieceType::None;
+}
+
+// ======================== Move picker ========================
+// Staged, lazy move ordering: TT move, then captures/promotions by MVV-LVA, then killers,
+// then quiets by history, then the captures SEE says lose material. Each stage is only
+// generated when reached, each move is scored once, and the best remaining move is pulled
+// by selection, so an early cutoff skips both the remaining generation and the ordering work.
+// In check there is one stage after the TT move: the legal evasions, all scored together
+// (good captures, killers, quiets by history, losing captures).
+enum class PickStage : u8 { TTMove, GenCaptures, Captures, Killer1, Killer2, GenQuiets, Quiets, BadCaptures,
+                            GenEvasions, Evasions, Done };
+
+struct MovePicker {
+    const Board& bd;
+    SearchContext& ctx;                // mutable only for the profile
+    Move ttMove{};
+    Move killers[2]{};
+    bool capturesOnly=false;
+    bool evasion=false;
+    int ply=0;
+    PickStage stage = PickStage::TTMove;
+    MoveList list;
+    int cur=0;
+    MoveList bad;       // losing captures set aside during the Captures stage (SEE < 0)
+    int badCur=0;
+
+    // inCheck: the side to move is in check (negamax knows already); quiescence never is.
+    MovePicker(const Board& b, SearchContext& c, const Move& tt, int p, bool capsOnly=false, bool inCheck=false)
+        : bd(b), ctx(c), capturesOnly(capsOnly), evasion(inCheck && !capsOnly), ply(p)
+    {
+        if(bd.isPseudoLegal(tt) && (!capturesOnly || isTactical(tt))) ttMove = tt;
+        else stage = evasion ? PickStage::GenEvasions : PickStage::GenCaptures;
+        if(!capturesOnly && !evasion && ply<MAX_PLY){
+            killers[0] = ctx.killer[ply][0];
+            killers[1] = ctx.killer[ply][1];
+        }
+    }
+
+    // Null moves (from==to) never match a generated move, so unset slots are harmless.
+    bool alreadyTried(const Move& m) const {
+        return sameMove(m, ttMove) || sameMove(m, killers[0]) || sameMove(m, killers[1]);
+    }
+
+    bool usableKiller(const Move& k) const {
+        return !sameMove(k, ttMove) && !isTactical(k) && bd.isPseudoLegal(k);
+    }
+
+    // deferBad: push losing captures to the bad list instead of returning them. The
+    // exchange is only evaluated for moves reached before a cutoff.
+    bool pickBest(Move& out, bool deferBad=false){
+        while(cur < list.count){
+            int best = cur;
+            for(int i=cur+1;i<list.count;i++)
+                if(list.scores[i] > list.scores[best]) best = i;
+            std::swap(list.moves[cur], list.moves[best]);
+            std::swap(list.scores[cur], list.scores[best]);
+            const Move& m = list.moves[cur++];
+            if(alreadyTried(m)) continue;
+            if(deferBad && m.promo==PieceType::None && !bd.seeGE(m, 0)){
+                bad.push_back(m);
+                continue;
+            }
+            out = m;
+            return true;
+        }
+        return false;
+    }
+
+    bool next(Move& out){
+        switch(stage){
+            case PickStage::TTMove:
+                stage = evasion ? PickStage::GenEvasions : PickStage::GenCaptures;
+                out = ttMove;
+                return true;
+
+            case PickStage::GenCaptures:
+                list.clear();
+                {
+                    STAT_TIME(ctx, movegenNs);
+                    bd.generate(list, GenType::Captures);
+                }
+                for(int i=0;i<list.count;i++){
+                    const Move& m = list.moves[i];
+                    list.scores[i] = mvvLvaScore(bd, m) + (m.promo==PieceType::Queen ? 8000 : 0);
+                }
+                cur = 0;
+                stage = PickStage::Captures;
+                [[fallthrough]];
+
+            case PickStage::Captures:
+                if(pickBest(out, !capturesOnly)) return true;
+                if(capturesOnly){ stage = PickStage::Done; return false; }
+                stage = PickStage::Killer1;
+                [[fallthrough]];
+
+            case PickStage::Killer1:
+                stage = PickStage::Killer2;
+                if(usableKiller(killers[0])){ out = killers[0]; return true; }
+                killers[0] = Move{};
+                [[fallthrough]];
+
+            case PickStage::Killer2:
+                stage = PickStage::GenQuiets;
+                if(!sameMove(killers[1], killers[0]) && usableKiller(killers[1])){ out = killers[1]; return true; }
+                killers[1] = Move{};
+                [[fallthrough]];
+
+            case PickStage::GenQuiets: {
+                list.clear();
+                {
+                    STAT_TIME(ctx, movegenNs);
+                    bd.generate(list, GenType::Quiets);
+                }
+                int side = (bd.stm==Color::White)?0:1;
+                for(int i=0;i<list.count;i++){
+                    const Move& m = list.moves[i];
+                    list.scores[i] = ctx.history[side][m.from][m.to];
+                }
+                cur = 0;
+                stage = PickStage::Quiets;
+                [[fallthrough]];
+            }
+
+            case PickStage::Quiets:
+                if(pickBest(out)) return true;
+                stage = PickStage::BadCaptures;
+                [[fallthrough]];
+
+            case PickStage::BadCaptures:
+                if(badCur < bad.count){ out = bad.moves[badCur++]; return true; }
+                stage = PickStage::Done;
+                return false;
+
+            case PickStage::GenEvasions:
+                list.clear();
+                {
+                    STAT_TIME(ctx, movegenNs);
+                    bd.generate(list, GenType::Evasions);
+                }
+                for(int i=0;i<list.count;i++) list.scores[i] = scoreMove(bd, ctx, list.moves[i], ttMove, ply);
+                cur = 0;
+                stage = PickStage::Evasions;
+                [[fallthrough]];
+
+            case PickStage::Evasions:
+                if(pickBest(out)) return true;
+                stage = PickStage::Done;
+                [[fallthrough]];
+
+            case PickStage::Done:
+                return false;
+        }
+        return false;
+    }
+};
+
+// Reading the clock costs far more than a node, so it and the shared stop flag are only
+// polled every TIME_CHECK_NODES calls (well under a millisecond at our speed).
+constexpr int TIME_CHECK_NODES = 1024;
+
+static inline bool timeUp(SearchContext& ctx){
+    if(ctx.stop) return true;
+    if(--ctx.clockCountdown > 0) return false;
+    ctx.clockCountdown = TIME_CHECK_NODES;
+
+    if(ctx.sharedStop && ctx.sharedStop->load(std::memory_order_relaxed)){
+        ctx.stop=true;
+        return true;
+    }
+    if(ctx.nodeLimit && ctx.stats.nodes.get() >= ctx.nodeLimit){
+        ctx.stop=true;
+        return true;
+    }
+    auto now = std::chrono::steady_clock::now();
+    int ms = (int)std::chrono::duration_cast<std::chrono::milliseconds>(now - ctx.start).count();
+    if(ms >= ctx.hardLimitMs.load(std::memory_order_relaxed)){
+        ctx.stop=true;
+        return true;
+    }
+    return false;
+}
+
+// Mate and tablebase scores are stored relative to the node (not the root) so they stay
+// valid when the same position is reached at a different ply.
+static int scoreToTT(int s, int ply){
+    if(s >= TB_BOUND) return s + ply;
+    if(s <= -TB_BOUND) return s - ply;
+    return s;
+}
+static int scoreFromTT(int s, int ply){
+    if(s >= TB_BOUND) return s - ply;
+    if(s <= -TB_BOUND) return s + ply;
+    return s;
+}
+
+// Delta pruning: a capture that can't lift stand pat to alpha even with this much
+// positional compensation on top of the victim is not searched.
+constexpr int DELTA_MARGIN = 200;
+
+// With LEAF, *leaf receives the position the returned score was taken from (eval tuning).
+template<bool LEAF>
+static int quiescence(Board& bd, SearchContext& ctx, int alpha, int beta, Board* leaf = nullptr){
+    if(timeUp(ctx)) return 0;
+    ctx.stats.qnodes.inc();
+
+    int stand;
+    {
+        STAT_TIME(ctx, evalNs);
+        stand = evaluate(bd, &ctx.pawns);
+    }
+    if constexpr(LEAF) *leaf = bd;
+    if(stand >= beta) return beta;
+    if(stand > alpha) alpha = stand;
+
+    MovePicker mp(bd, ctx, Move{}, 0, true);
+    Move m;
+    while(mp.next(m)){
+        if(m.promo==PieceType::None){
+            int victim = m.isEnPassant ? pieceValue(PieceType::Pawn) : pieceValue(bd.at(m.to).t);
+            if(stand + victim + DELTA_MARGIN <= alpha) continue;
+            if(!bd.seeGE(m, 0)) continue;
+        }
+        Undo u{};
+        if(!bd.makeMove(m,u)) continue;
+        std::conditional_t<LEAF, Board, char> childLeaf{};
+        int score;
+        if constexpr(LEAF) score = -quiescence<true>(bd, ctx, -beta, -alpha, &childLeaf);
+        else score = -quiescence<false>(bd, ctx, -beta, -alpha);
+        bd.undoMove(u);
+
+        if(score > alpha){
+            if constexpr(LEAF) *leaf = childLeaf;
+            if(score >= beta) return beta;
+            alpha = score;
+        }
+    }
+
+    return alpha;
+}
+
+int quiescenceLeaf(Board& bd, SearchContext& ctx, Board& leaf){
+    ctx.stop = false;
+    ctx.clockCountdown = TIME_CHECK_NODES;
+    return quiescence<true>(bd, ctx, -INF, INF, &leaf);
+}
+
+SearchConfig searchConfig;
+
+// ctx.repetition ends with the current position. Nothing before the last irreversible move
+// (halfmoveClock plies back) can recur, and only every second entry has the same side to
+// move, so the scan is bounded by the 50-move counter instead of the game length.
+static bool isRepetition(const SearchContext& ctx, const Board& bd){
+    const std::vector<u64>& st = ctx.repetition;
+    int last = (int)st.size() - 1;
+    int limit = std::min(bd.halfmoveClock, last);
+    for(int i=4; i<=limit; i+=2)
+        if(st[last-i]==bd.hash) return true;
+    return false;
+}
+
+static void initReductions(SearchContext& ctx){
+    const SearchConfig& cfg = searchConfig;
+    for(int d=0; d<64; d++){
+        for(int m=0; m<64; m++){
+            double r = (d && m) ? cfg.lmrBase + std::log(double(d)) * std::log(double(m)) / cfg.lmrDivisor : 0.0;
+            ctx.reduction[d][m] = (u8)std::clamp(int(r), 0, 63);
+        }
+    }
+}
+
+static int negamax(Board& bd, SearchContext& ctx, int depth, int alpha, int beta, int ply, bool allowNull=true){
+    if(timeUp(ctx)) return 0;
+    ctx.stats.nodes.inc();
+
+    if(bd.insufficientMaterial()) return 0;
+    if(bd.halfmoveClock >= 100) return 0;
+    if(ply >= MAX_PLY) return evaluate(bd, &ctx.pawns);
+
+    if(isRepetition(ctx, bd)) return 0;
+
+    Move ttMove{};
+    TTData e;
+    STAT_INC(ctx, ttProbes);
+    if(ctx.tt->probe(bd.hash, e)){
+        STAT_INC(ctx, ttHits);
+        ttMove = decodeMove(e.move, bd);
+        if(e.depth >= depth){
+            int s = scoreFromTT(e.score, ply);
+            if(e.flag==TTFlag::Exact){ STAT_INC(ctx, ttCutoffs); return s; }
+            if(e.flag==TTFlag::Lower) alpha = std::max(alpha, s);
+            else if(e.flag==TTFlag::Upper) beta = std::min(beta, s);
+            if(alpha >= beta){ STAT_INC(ctx, ttCutoffs); return s; }
+        }
+    }
+
+    // Tablebase hit: exact for a win/draw/loss, so it ends the node unless the bound it gives
+    // (a real mate can be better than TB_WIN) still leaves the window open. Not at the root,
+    // which has its own DTZ probe, nor at the depth-0 nodes that drop into quiescence.
+    TBWdl wdl;
+    if(ply > 0 && depth >= std::max(1, searchConfig.tbProbeDepth)
+       && popcount(bd.occupied()) <= searchConfig.tbProbeLimit && tbProbeWDL(bd, wdl)){
+        ctx.stats.tbHits.inc();
+        int s = (wdl==TBWdl::Win) ? TB_WIN - ply : (wdl==TBWdl::Loss) ? -TB_WIN + ply : 0;
+        TTFlag flag = (wdl==TBWdl::Win) ? TTFlag::Lower : (wdl==TBWdl::Loss) ? TTFlag::Upper : TTFlag::Exact;
+        if(flag==TTFlag::Exact || (flag==TTFlag::Lower ? s >= beta : s <= alpha)){
+            ctx.tt->store(bd.hash, std::min(depth + 6, MAX_PLY - 1), scoreToTT(s, ply), flag, 0);
+            return s;
+        }
+    }
+
+    if(depth<=0){
+        STAT_TIME(ctx, qsearchNs);
+        return quiescence<false>(bd, ctx, alpha, beta);
+    }
+
+    const SearchConfig& cfg = searchConfig;
+    const bool pvNode = beta - alpha > 1;
+    const bool inCheck = bd.inCheck(bd.stm);
+    int staticEval = -INF;
+    if(!inCheck){
+        STAT_TIME(ctx, evalNs);
+        staticEval = evaluate(bd, &ctx.pawns);
+    }
+    if(pvNode) STAT_INC(ctx, pvNodes);
+    else STAT_INC(ctx, zwNodes);
+
+    // Reverse futility: so far above beta that a shallow search won't bring it back.
+    if(cfg.reverseFutility && !pvNode && !inCheck && depth <= cfg.rfpMaxDepth &&
+       std::abs(beta) < MATE_BOUND && staticEval - cfg.rfpMargin*depth >= beta){
+        STAT_INC(ctx, rfpPrunes);
+        return staticEval;
+    }
+
+    // Null move: if passing still fails high at reduced depth, a real move will too. Not
+    // twice in a row, and not with only king and pawns, where passing may be the best move.
+    if(cfg.nullMove && allowNull && !pvNode && !inCheck && depth >= cfg.nullMinDepth &&
+       staticEval >= beta && std::abs(beta) < MATE_BOUND && bd.hasNonPawnMaterial(bd.stm)){
+        int R = 3 + depth/4 + std::min(3, (staticEval - beta)/200);
+        STAT_INC(ctx, nullTried);
+        Undo u{};
+        bd.makeNullMove(u);
+        ctx.repetition.push_back(bd.hash);
+        int score = -negamax(bd, ctx, depth-1-R, -beta, -beta+1, ply+1, false);
+        ctx.repetition.pop_back();
+        bd.undoNullMove(u);
+        if(ctx.stop) return 0;
+
+        if(score >= beta){
+            if(score >= MATE_BOUND) score = beta;   // unproven mate
+            if(depth < cfg.nullVerifyDepth){ STAT_INC(ctx, nullCutoffs); return score; }
+            if(negamax(bd, ctx, depth-1-R, beta-1, beta, ply, false) >= beta){ STAT_INC(ctx, nullCutoffs); return score; }
+            if(ctx.stop) return 0;
+        }
+    }
+
+    const bool futile = cfg.futility && !pvNode && !inCheck && depth <= cfg.futilityMaxDepth &&
+                        std::abs(alpha) < MATE_BOUND &&
+                        staticEval + cfg.futilityBase + cfg.futilityMargin*depth <= alpha;
+    const int lmpLimit = (cfg.lateMovePruning && !pvNode && !inCheck && depth <= cfg.lmpMaxDepth)
+                       ? cfg.lmpBase + depth*depth : INT_MAX;
+
+    int best = -INF;
+    Move bestM{};
+
+    int originalAlpha = alpha;
+
+    MovePicker mp(bd, ctx, ttMove, ply, false, inCheck);
+    Move m;
+    int legalMoves = 0;
+    int quietsTried = 0;
+    while(mp.next(m)){
+        bool isQuiet = !isTactical(m);
+        // Some legal move has been searched by then, so mate/stalemate detection still holds.
+        if(isQuiet && quietsTried >= lmpLimit){ STAT_INC(ctx, lmpPrunes); continue; }
+
+        Undo u{};
+        if(!bd.makeMove(m,u)) continue;
+        int i = legalMoves++;
+        if(isQuiet) quietsTried++;
+
+        const bool givesCheck = bd.inCheck(bd.stm);
+        if(futile && isQuiet && !givesCheck && i > 0){
+            STAT_INC(ctx, futilityPrunes);
+            bd.undoMove(u);
+            continue;
+        }
+        ctx.tt->prefetch(bd.hash);
+
+        ctx.repetition.push_back(bd.hash);
+
+        int newDepth = depth - 1;
+        if(givesCheck){
+          newDepth++;
+        }
+        int score=0;
+
+        int r = 0;
+        if(cfg.lmr && depth >= 3 && i >= 3 && isQuiet && !givesCheck && !inCheck){
+            r = ctx.reduction[std::min(depth, 63)][std::min(i, 63)];
+            if(pvNode) r--;
+            if(sameMove(m, ctx.killer[ply][0]) || sameMove(m, ctx.killer[ply][1])) r--;
+            r = std::clamp(r, 0, newDepth-1);
+        }
+        if(r > 0){
+            STAT_INC(ctx, lmrReduced);
+            score = -negamax(bd, ctx, newDepth-r, -alpha-1, -alpha, ply+1);
+            if(score > alpha){
+                STAT_INC(ctx, lmrResearched);
+                score = -negamax(bd, ctx, newDepth, -beta, -alpha, ply+1);
+            }
+        } else {
+            score = -negamax(bd, ctx, newDepth, -beta, -alpha, ply+1);
+        }
+
+        ctx.repetition.pop_back();
+        bd.undoMove(u);
+
+        if(ctx.stop) return 0;
+
+        if(score > best){
+            best = score;
+            bestM = m;
+        }
+
+        alpha = std::max(alpha, score);
+        if(alpha >= beta){
+            STAT_INC(ctx, failHighs);
+            if(i==0) STAT_INC(ctx, failHighsFirst);
+            if(isQuiet && ply<MAX_PLY){
+                if(!sameMove(ctx.killer[ply][0], m)){
+                    ctx.killer[ply][1] = ctx.killer[ply][0];
+                    ctx.killer[ply][0] = m;
+                }
+                int side = (bd.stm==Color::White)?0:1;
+                ctx.history[side][m.from][m.to] = std::min(90000, ctx.history[side][m.from][m.to] + depth*depth*8);
+            }
+            break;
+        }
+    }
+
+    if(legalMoves==0){
+        if(inCheck) return -MATE + ply;
+        return 0;
+    }
+
+    TTFlag flag = TTFlag::Exact;
+    if(best <= originalAlpha) flag = TTFlag::Upper;
+    else if(best >= beta) flag = TTFlag::Lower;
+    ctx.tt->store(bd.hash, depth, scoreToTT(best, ply), flag, encodeMove(bestM));
+
+    return best;
+}
+
+Move searchBestMove(Board& bd, SearchContext& ctx, int maxDepth){
+    ctx.stats = {};
+    ctx.stop = false;
+    ctx.clockCountdown = 0;
+
+    ctx.repetition.reserve(ctx.repetition.size() + MAX_PLY + 1);
+    ctx.repetition.push_back(bd.hash);
+    initReductions(ctx);
+
+    MoveList rootMoves;
+    {
+        STAT_TIME(ctx, movegenNs);
+        bd.genLegalMoves(rootMoves);
+    }
+    if(rootMoves.empty()) return Move{};
+    ctx.nnue.reset();
+    if(evalConfig.nnue && nnueLoaded()) bd.nn = &ctx.nnue;
+    if(!ctx.rootFilter.empty()){
+        MoveList kept;
+        for(const Move& m : rootMoves)
+            for(const Move& f : ctx.rootFilter)
+                if(sameMove(m, f)){ kept.push_back(m); break; }
+        if(!kept.empty()) rootMoves = kept;
+    }
+
+    Move bestMove = rootMoves[0];
+    int bestScore = -INF;
+    TimeManager tm;
+
+    // Lazy SMP: odd helpers start one ply deeper so threads spread over depths.
+    int firstDepth = (ctx.threadId & 1) ? std::min(2, maxDepth) : 1;
+
+    for(int d=firstDepth; d<=maxDepth; d++){
+        if(timeUp(ctx)) break;
+
+        int alpha = -INF;
+        int beta  = INF;
+        if(d >= 3 && std::abs(bestScore) < MATE/2){
+            alpha = bestScore - 50;
+            beta  = bestScore + 50;
+        }
+
+        Move ttMove{};
+        TTData e;
+        if(ctx.tt->probe(bd.hash, e)) ttMove = decodeMove(e.move, bd);
+
+        for(int i=0;i<rootMoves.size();i++)
+            rootMoves.scores[i] = scoreMove(bd, ctx, rootMoves[i], ttMove, 0);
+        rootMoves.sortByScore();
+
+        int localBest=-INF;
+        Move localMove = rootMoves[0];
+
+        for(const auto& m : rootMoves){
+            if(timeUp(ctx)) break;
+            Undo u{};
+            if(!bd.makeMove(m,u)) continue;
+            ctx.tt->prefetch(bd.hash);
+
+            ctx.repetition.push_back(bd.hash);
+            int score = -negamax(bd, ctx, d-1, -beta, -alpha, 1);
+            ctx.repetition.pop_back();
+
+            bd.undoMove(u);
+
+            if(ctx.stop) break;
+
+            if(score > localBest){
+                localBest = score;
+                localMove = m;
+            }
+
+
+            alpha = std::max(alpha, score);
+
+            if(alpha >= beta){
+                alpha = -INF;
+                beta = INF;
+                Undo u2{};
+                if(bd.makeMove(m,u2)){
+                    ctx.repetition.push_back(bd.hash);
+                    int score2 = -negamax(bd, ctx, d-1, -INF, INF, 1);
+                    ctx.repetition.pop_back();
+                    bd.undoMove(u2);
+                    if(!ctx.stop && score2 > localBest){
+                        localBest = score2;
+                        localMove = m;
+                    }
+                }
+                break;
+            }
+        }
+
+        if(!ctx.stop){
+            bestScore = localBest;
+            bestMove = localMove;
+            ctx.stats.depthReached = d;
+            ctx.stats.bestScore = bestScore;
+#ifdef ORRYX_STATS
+            ctx.stats.profile.iterNodes[d] = ctx.stats.nodes + ctx.stats.qnodes;
+#endif
+            // The root is never stored by negamax; keep it in the TT so PV extraction
+            // and the next iteration's ordering start from the best move.
+            ctx.tt->store(bd.hash, d, scoreToTT(bestScore, 0), TTFlag::Exact, encodeMove(bestMove));
+            if(ctx.onIteration) ctx.onIteration(ctx);
+
+            // Helpers have no limits of their own; thread 0 stops them when it is done.
+            int soft = tm.scaledSoftLimit(ctx.softLimitMs.load(std::memory_order_relaxed), bestMove, bestScore);
+            auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - ctx.start).count();
+            if(elapsed >= soft) break;
+            if(rootMoves.size()==1 && ctx.hardLimitMs.load(std::memory_order_relaxed)!=INT_MAX) break;
+        }
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    ctx.stats.timeMs = (int)std::chrono::duration_cast<std::chrono::milliseconds>(end - ctx.start).count();
+    bd.nn = nullptr;
+    return bestMove;
+}
+
+// ======================== Lazy SMP ========================
+void SearchPool::setThreads(int n){
+    n = std::max(1, n);
+    workers.clear();
+    for(int i=0;i<n;i++){
+        auto c = std::make_unique<SearchContext>();
+        c->tt = &tt;
+        c->threadId = i;
+        c->sharedStop = &stop;
+        workers.push_back(std::move(c));
+    }
+}
+
+void SearchPool::newGame(){
+    clearHash();
+    for(auto& w : workers) w->pawns.clear();
+}
+
+void SearchPool::prepare(const TimeBudget& budget){
+    stop.store(false);
+    startTime = std::chrono::steady_clock::now();
+    for(auto& w : workers){
+        w->start = startTime;
+        w->softLimitMs.store(w->threadId==0 ? budget.softMs : INT_MAX, std::memory_order_relaxed);
+        w->hardLimitMs.store(w->threadId==0 ? budget.hardMs : INT_MAX, std::memory_order_relaxed);
+        w->nodeLimit = (w->threadId==0) ? nodeLimit : 0;
+    }
+}
+
+Move SearchPool::run(const Board& bd, int maxDepth){
+    tt.newSearch();
+    for(auto& w : workers){
+        for(auto& k : w->killer) k[0] = k[1] = Move{};
+        std::memset(w->history, 0, sizeof(w->history));
+        w->repetition = gameHistory;
+    }
+
+    // The root probe is not thread-safe, so it runs here once. With DTZ it finds the move
+    // that keeps the result under the 50-move rule; the search then only looks at that move.
+    std::vector<Move> rootFilter;
+    Move tbMove;
+    TBWdl tbResult;
+    if(tbProbeRoot(bd, tbMove, tbResult)) rootFilter.push_back(tbMove);
+    for(auto& w : workers) w->rootFilter = rootFilter;
+    if(onIteration){
+        workers[0]->onIteration = [this](const SearchContext& c){
+            SearchStats s = c.stats;
+            s.nodes = NodeCounter{};
+            s.nodes.add(totalNodes());
+            s.timeMs = elapsedMs();
+            onIteration(s);
+        };
+    } else {
+        workers[0]->onIteration = nullptr;
+    }
+
+    std::vector<std::thread> helpers;
+    for(size_t i=1;i<workers.size();i++){
+        SearchContext* c = workers[i].get();
+        Board helperBoard = bd;
+        helpers.emplace_back([c, helperBoard, maxDepth]() mutable {
+            searchBestMove(helperBoard, *c, maxDepth);
+        });
+    }
+
+    Board rootBoard = bd;
+    Move best = searchBestMove(rootBoard, *workers[0], maxDepth);
+
+    stop.store(true);
+    for(auto& t : helpers) t.join();
+
+    stats = workers[0]->stats;
+    for(size_t i=1;i<workers.size();i++){
+        stats.nodes.add(workers[i]->stats.nodes);
+        stats.qnodes.add(workers[i]->stats.qnodes);
+        stats.tbHits.add(workers[i]->stats.tbHits);
+        stats.profile.add(workers[i]->stats.profile, false);
+    }
+    if(!rootFilter.empty()) stats.tbHits.inc();
+    return best;
+}
+
+int SearchPool::elapsedMs() const {
+    auto now = std::chrono::steady_clock::now();
+    return (int)std::chrono::duration_cast<std::chrono::milliseconds>(now - startTime).count();
+}
+
+u64 SearchPool::totalNodes() const {
+    u64 n = 0;
+    for(const auto& w : workers) n += w->stats.nodes.get();
+    return n;
+}
+
+std::string extractPVFromTT(Board bd, const TranspositionTable& tt, int maxPlies){
+    std::string pv;
+    std::vector<u64> seen;
+    seen.reserve((size_t)maxPlies+2);
+
+    for(int ply=0; ply<maxPlies; ply++){
+        if(std::find(seen.begin(), seen.end(), bd.hash) != seen.end()) break;
+        seen.push_back(bd.hash);
+
+        TTData e;
+        if(!tt.probe(bd.hash, e)) break;
+
+        Move m = decodeMove(e.move, bd);
+
+        MoveList leg;
+        bd.genLegalMoves(leg);
+
+        auto it = std::find_if(leg.begin(), leg.end(), [&](const Move& x){
+            return x.from==m.from && x.to==m.to && x.promo==m.promo;
+        });
+        if(it == leg.end()) break;
+
+        Undo u{};
+        if(!bd.makeMove(*it, u)) break;
+
+        if(!pv.empty()) pv += " ";
+        pv += moveToUCI(*it);
+    }
+    return pv;
+}
+
+// ======================== Instrumentation ========================
+#ifdef ORRYX_STATS
+void SearchProfile::add(const SearchProfile& o, bool iterations){
+    pvNodes += o.pvNodes;              zwNodes += o.zwNodes;
+    ttProbes += o.ttProbes;            ttHits += o.ttHits;            ttCutoffs += o.ttCutoffs;
+    failHighs += o.failHighs;          failHighsFirst += o.failHighsFirst;
+    lmrReduced += o.lmrReduced;        lmrResearched += o.lmrResearched;
+    nullTried += o.nullTried;          nullCutoffs += o.nullCutoffs;
+    rfpPrunes += o.rfpPrunes;          futilityPrunes += o.futilityPrunes;   lmpPrunes += o.lmpPrunes;
+    movegenNs += o.movegenNs;          evalNs += o.evalNs;            qsearchNs += o.qsearchNs;
+    if(iterations)
+        for(int d=0; d<MAX_PLY; d++) iterNodes[d] += o.iterNodes[d];
+}
+
+static double percent(u64 part, u64 whole){ return whole ? 100.0 * double(part) / double(whole) : 0.0; }
+
+// Nodes of each completed iteration (1..last), from the running totals.
+static std::vector<u64> iterationNodes(const SearchProfile& p){
+    std::vector<u64> n;
+    u64 prev = 0;
+    for(int d=1; d<MAX_PLY && p.iterNodes[d]; d++){
+        n.push_back(p.iterNodes[d] - prev);
+        prev = p.iterNodes[d];
+    }
+    return n;
+}
+
+std::string searchProfileReport(const SearchProfile& p){
+    char buf[256];
+    std::string s;
+    std::snprintf(buf, sizeof(buf), "nodes pv %llu zw %llu | tt probes %llu hit %.1f%% cut %.1f%%\n",
+                  (unsigned long long)p.pvNodes, (unsigned long long)p.zwNodes, (unsigned long long)p.ttProbes,
+                  percent(p.ttHits, p.ttProbes), percent(p.ttCutoffs, p.ttProbes));
+    s += buf;
+    std::snprintf(buf, sizeof(buf), "fail high %llu, first move %.1f%% | lmr %llu, re-searched %.1f%%\n",
+                  (unsigned long long)p.failHighs, percent(p.failHighsFirst, p.failHighs),
+                  (unsigned long long)p.lmrReduced, percent(p.lmrResearched, p.lmrReduced));
+    s += buf;
+    std::snprintf(buf, sizeof(buf), "null %llu, cut %.1f%% | rfp %llu | futility %llu | lmp %llu\n",
+                  (unsigned long long)p.nullTried, percent(p.nullCutoffs, p.nullTried),
+                  (unsigned long long)p.rfpPrunes, (unsigned long long)p.futilityPrunes, (unsigned long long)p.lmpPrunes);
+    s += buf;
+    std::snprintf(buf, sizeof(buf), "time movegen %.1f ms | eval %.1f ms | qsearch %.1f ms\n",
+                  p.movegenNs / 1e6, p.evalNs / 1e6, p.qsearchNs / 1e6);
+    s += buf;
+    std::vector<u64> n = iterationNodes(p);
+    s += "ebf";
+    for(size_t i=1; i<n.size(); i++){
+        std::snprintf(buf, sizeof(buf), " d%zu %.2f", i+1, n[i-1] ? double(n[i]) / double(n[i-1]) : 0.0);
+        s += buf;
+    }
+    return s;
+}
+
+void writeSearchProfileJSON(std::ostream& os, const SearchProfile& p){
+    os << "{\"nodes\":{\"pv\":" << p.pvNodes << ",\"zw\":" << p.zwNodes << "}"
+       << ",\"tt\":{\"probes\":" << p.ttProbes << ",\"hits\":" << p.ttHits << ",\"cutoffs\":" << p.ttCutoffs << "}"
+       << ",\"failHigh\":{\"total\":" << p.failHighs << ",\"first\":" << p.failHighsFirst << "}"
+       << ",\"lmr\":{\"reduced\":" << p.lmrReduced << ",\"researched\":" << p.lmrResearched << "}"
+       << ",\"pruning\":{\"nullTried\":" << p.nullTried << ",\"nullCutoffs\":" << p.nullCutoffs
+       << ",\"reverseFutility\":" << p.rfpPrunes << ",\"futility\":" << p.futilityPrunes << ",\"lateMove\":" << p.lmpPrunes << "}"
+       << ",\"timeNs\":{\"movegen\":" << p.movegenNs << ",\"eval\":" << p.evalNs << ",\"qsearch\":" << p.qsearchNs << "}"
+       << ",\"iterations\":[";
+    std::vector<u64> n = iterationNodes(p);
+    for(size_t i=0; i<n.size(); i++){
+        os << (i ? "," : "") << "{\"depth\":" << (i+1) << ",\"nodes\":" << n[i];
+        if(i && n[i-1]) os << ",\"ebf\":" << double(n[i]) / double(n[i-1]);
+        os << "}";
+    }
+    os << "]}";
+}
+#else
+std::string searchProfileReport(const SearchProfile&){ return std::string(); }
+void writeSearchProfileJSON(std::ostream&, const SearchProfile&){}
+#endif
@@ -0,0 +1,206 @@
+// engine/search.h  (iterative deepening alpha-beta + Lazy SMP pool)
+#pragma once
+
+#include "eval.h"
+#include "timeman.h"
+#include "tt.h"
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// ======================== Search (ID + TT + QS + Ordering) ========================
+// Scores must fit the TT's 16-bit score field.
+constexpr int INF = 32500;
+constexpr int MATE = 32000;
+constexpr int MATE_BOUND = MATE - 1000;   // anything beyond is a mate-in-N score
+constexpr int MAX_PLY = 128;
+constexpr int TB_WIN = MATE_BOUND - MAX_PLY - 1;   // tablebase win; below every mate score
+constexpr int TB_BOUND = TB_WIN - MAX_PLY;         // anything beyond is a tablebase or mate score
+
+// Forward pruning and reductions. Each technique can be switched off on its own so its
+// effect on node counts (bench) and strength can be measured; depths are in plies.
+struct SearchConfig {
+    bool nullMove = true;           // skip our move; if a reduced search still fails high, cut
+    int  nullMinDepth = 3;
+    int  nullVerifyDepth = 10;      // from here on a null cutoff must be confirmed without null moves
+
+    bool reverseFutility = true;    // static eval beats beta by a depth-scaled margin: cut
+    int  rfpMaxDepth = 6;
+    int  rfpMargin = 80;            // per ply
+
+    bool futility = true;           // quiet moves can't lift static eval to alpha: skip them
+    int  futilityMaxDepth = 3;
+    int  futilityBase = 100;
+    int  futilityMargin = 80;       // per ply
+
+    bool lateMovePruning = true;    // after enough quiets at low depth, skip the rest
+    int  lmpMaxDepth = 4;
+    int  lmpBase = 3;               // quiets allowed: lmpBase + depth*depth
+
+    bool lmr = true;                // reduction = lmrBase + ln(depth) * ln(moveNumber) / lmrDivisor
+    double lmrBase = 0.75;
+    double lmrDivisor = 2.25;
+
+    int  tbProbeDepth = 1;          // Syzygy WDL probes below the root from this depth on,
+    int  tbProbeLimit = 7;          // with at most this many pieces on the board
+};
+extern SearchConfig searchConfig;
+
+// Node counter that other threads may read while the owner is counting (live info
+// lines). Relaxed load + store is as cheap as a plain increment, unlike fetch_add.
+struct NodeCounter {
+    std::atomic<u64> n{0};
+
+    NodeCounter() = default;
+    NodeCounter(const NodeCounter& o) : n(o.get()) {}
+    NodeCounter& operator=(const NodeCounter& o){ n.store(o.get(), std::memory_order_relaxed); return *this; }
+
+    void inc(){ n.store(n.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); }
+    void add(u64 v){ n.store(n.load(std::memory_order_relaxed) + v, std::memory_order_relaxed); }
+    u64 get() const { return n.load(std::memory_order_relaxed); }
+    operator u64() const { return get(); }
+};
+
+// ======================== Instrumentation ========================
+// Where the nodes and the time go, for tuning ordering and pruning. Only compiled in with
+// -DORRYX_STATS (STATS=1 in scripts/build_engine.sh); otherwise SearchProfile is empty and
+// the search does no counting at all. The timers read the clock around every eval and move
+// generation, so an instrumented build is noticeably slower, but its node counts are the same.
+#ifdef ORRYX_STATS
+constexpr bool SEARCH_PROFILING = true;
+#else
+constexpr bool SEARCH_PROFILING = false;
+#endif
+
+struct SearchProfile {
+#ifdef ORRYX_STATS
+    u64 pvNodes = 0;           // interior nodes searched with an open window
+    u64 zwNodes = 0;           // ... and with a zero window
+    u64 ttProbes = 0;
+    u64 ttHits = 0;
+    u64 ttCutoffs = 0;         // hits deep enough to end the node
+    u64 failHighs = 0;         // beta cutoffs after searching moves
+    u64 failHighsFirst = 0;    // ... by the first legal move
+    u64 lmrReduced = 0;        // moves searched at reduced depth
+    u64 lmrResearched = 0;     // ... that beat alpha and were searched again at full depth
+    u64 nullTried = 0;
+    u64 nullCutoffs = 0;
+    u64 rfpPrunes = 0;         // nodes cut by reverse futility
+    u64 futilityPrunes = 0;    // quiet moves skipped by futility
+    u64 lmpPrunes = 0;         // quiet moves skipped by late move pruning
+    u64 movegenNs = 0;         // staged generation and the root move list
+    u64 evalNs = 0;            // every evaluate() call, quiescence included
+    u64 qsearchNs = 0;         // quiescence searches as a whole, their eval and movegen included
+    u64 iterNodes[MAX_PLY]{};  // nodes + qnodes when iteration d completed (main thread)
+
+    // iterations: also add iterNodes (bench sums over positions; Lazy SMP helpers don't).
+    void add(const SearchProfile& o, bool iterations);
+#else
+    void add(const SearchProfile&, bool){}
+#endif
+};
+
+// Human-readable summary, a few lines (effective branching factor per iteration included),
+// and the same numbers as one JSON object. Both are empty without ORRYX_STATS.
+std::string searchProfileReport(const SearchProfile& p);
+void writeSearchProfileJSON(std::ostream& os, const SearchProfile& p);
+
+struct SearchStats {
+    NodeCounter nodes;
+    NodeCounter qnodes;
+    NodeCounter tbHits;
+    int depthReached=0;
+    int bestScore=0;
+    int timeMs=0;
+    SearchProfile profile;     // empty unless built with ORRYX_STATS
+};
+
+// Per-thread search state. The TT is shared; killers, history and the pawn table are
+// private to each thread.
+struct SearchContext {
+    TranspositionTable* tt = nullptr;
+    SearchStats stats;
+    std::chrono::steady_clock::time_point start;     // set by the caller before the search
+    std::atomic<int> softLimitMs{INT_MAX};           // both may change mid-search (ponderhit)
+    std::atomic<int> hardLimitMs{INT_MAX};
+    int clockCountdown = 0;                          // nodes until the clock is read again
+    u64 nodeLimit = 0;                               // stop after this many nodes (0 = none)
+    bool stop=false;
+    const std::atomic<bool>* sharedStop = nullptr;   // raised to end the search early
+    int threadId = 0;                                // 0 = main thread
+
+    Move killer[MAX_PLY][2]{};
+    u8 reduction[64][64]{};      // [depth][moveNumber], rebuilt from searchConfig per search
+    int history[2][64][64]{};
+    PawnHashTable pawns;
+    NNUEStack nnue;
+    std::vector<u64> repetition;   // position hashes from the game start to the current node
+    std::vector<Move> rootFilter;  // if non-empty, only these root moves are searched
+
+    // Called by the main thread after every completed iteration.
+    std::function<void(const SearchContext&)> onIteration;
+};
+
+// Iterative deepening from bd. ctx.start and the time limits must already be set, and
+// ctx.repetition must hold the hashes of the game positions before bd (oldest first).
+Move searchBestMove(Board& bd, SearchContext& ctx, int maxDepth);
+
+// Quiescence score of bd (side to move, full window) and the quiet position it was taken
+// from. Used by the eval tuner; ctx needs no time limit.
+int quiescenceLeaf(Board& bd, SearchContext& ctx, Board& leaf);
+
+// ======================== Lazy SMP ========================
+// N threads search the same root independently against one shared TT; they cooperate only
+// through the entries they leave there. Thread 0 runs on the caller and owns the time limit
+// and the result; helpers run until the shared stop flag is raised.
+struct SearchPool {
+    TranspositionTable tt;
+    std::vector<std::unique_ptr<SearchContext>> workers;   // workers[0] = main thread
+    std::atomic<bool> stop{false};                         // raised by thread 0 when done, or by stopSearch()
+    SearchStats stats;                                     // aggregated over all threads
+    std::chrono::steady_clock::time_point startTime;
+    std::vector<u64> gameHistory;                          // hashes of the positions played before the root, oldest first
+    u64 nodeLimit = 0;                                     // main-thread node budget per search (0 = none)
+
+    // Receives aggregated stats after each completed iteration of the main thread.
+    std::function<void(const SearchStats&)> onIteration;
+
+    explicit SearchPool(int threads = 1){ setThreads(threads); }
+
+    void setThreads(int n);
+    int threadCount() const { return (int)workers.size(); }
+
+    // Forget everything learned so far. Killers and history are reset per search anyway.
+    void newGame();
+    // The table is allocated and zeroed by as many threads as the pool has.
+    void resizeHash(size_t mb){ tt.resizeMB(mb, threadCount()); }
+    void clearHash(){ tt.clear(threadCount()); }
+
+    // prepare() arms the clock and clears the stop flag; run() does the search. They are
+    // split so a front end can prepare on its own thread and run on a worker, and a stop
+    // or time change it sends right after can never be overwritten by the worker.
+    void prepare(const TimeBudget& budget);
+    Move run(const Board& bd, int maxDepth);
+    Move search(const Board& bd, int maxDepth, const TimeBudget& budget){
+        prepare(budget);
+        return run(bd, maxDepth);
+    }
+    Move search(const Board& bd, int maxDepth, int timeLimitMs){
+        return search(bd, maxDepth, TimeBudget::fixed(timeLimitMs));
+    }
+
+    void stopSearch(){ stop.store(true); }
+    void setTimeBudget(const TimeBudget& b){
+        workers[0]->softLimitMs.store(b.softMs, std::memory_order_relaxed);
+        workers[0]->hardLimitMs.store(b.hardMs, std::memory_order_relaxed);
+    }
+    int elapsedMs() const;
+    u64 totalNodes() const;
+};
+
+std::string extractPVFromTT(Board bd, const TranspositionTable& tt, int maxPlies=12);
@@ -0,0 +1,53 @@
+// engine/service.cpp
+#include "service.h"
+
+static SearchInfo makeInfo(const SearchStats& s, std::string pv){
+    SearchInfo info;
+    info.depth = s.depthReached;
+    info.score = s.bestScore;
+    info.nodes = s.nodes;
+    info.qnodes = s.qnodes;
+    info.timeMs = s.timeMs;
+    info.nps = (s.timeMs > 0) ? info.nodes * 1000 / u64(s.timeMs) : info.nodes;
+    info.pv = std::move(pv);
+    if(SEARCH_PROFILING) info.profile = searchProfileReport(s.profile);
+    return info;
+}
+
+JobHandle SearchService::submit(const Board& bd, std::vector<u64> history, int maxDepth, const TimeBudget& budget){
+    cancel();
+
+    JobHandle job = std::make_shared<SearchJob>();
+    job->id = nextId++;
+    current = job;
+
+    // The callback runs on the main search thread only, so it is the queue's one producer.
+    pool.gameHistory = std::move(history);
+    pool.onIteration = [this, job, bd](const SearchStats& s){
+        job->updates.push(makeInfo(s, extractPVFromTT(bd, pool.tt, s.depthReached)));
+    };
+
+    // prepare() before the thread starts, so a cancel() right after submit is not lost.
+    pool.prepare(budget);
+    worker = std::thread([this, job, bd, maxDepth](){
+        Move best = pool.run(bd, maxDepth);
+        job->bestMove = best;
+        job->final = makeInfo(pool.stats, extractPVFromTT(bd, pool.tt, 12));
+        job->finished.store(true, std::memory_order_release);
+    });
+    return job;
+}
+
+void SearchService::cancel(){
+    if(!worker.joinable()) return;
+    if(current && !current->finished.load(std::memory_order_acquire)){
+        current->cancelled.store(true);
+        pool.stopSearch();
+    }
+    worker.join();
+    pool.onIteration = nullptr;
+}
+
+void SearchService::ponderHit(const TimeBudget& budget){
+    if(busy()) pool.setTimeBudget(budget.shiftedBy(pool.elapsedMs()));
+}
@@ -0,0 +1,78 @@
+// engine/service.h  (asynchronous search jobs for interactive front ends)
+#pragma once
+
+#include "search.h"
+#include "spsc_queue.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// One completed iteration, as shown to the user.
+struct SearchInfo {
+    int depth = 0;
+    int score = 0;
+    u64 nodes = 0;
+    u64 qnodes = 0;
+    int timeMs = 0;
+    u64 nps = 0;
+    std::string pv;
+    bool book = false;   // the move came from the opening book; nothing was searched
+    std::string profile; // searchProfileReport() of the search; empty unless built with ORRYX_STATS
+};
+
+// A submitted search. The search thread fills `updates` and, last of all, sets finished;
+// the submitting thread drains `updates` and reads the result once finished is true.
+struct SearchJob {
+    u64 id = 0;
+    SpscQueue<SearchInfo, 64> updates;   // one entry per iteration; dropped if the owner falls behind
+    std::atomic<bool> finished{false};
+    std::atomic<bool> cancelled{false};   // set by SearchService::cancel(); the result may be partial
+
+    // Valid once finished.
+    Move bestMove{};
+    SearchInfo final;
+};
+using JobHandle = std::shared_ptr<SearchJob>;
+
+// Owns a SearchPool and runs at most one job at a time on its own thread. Every call
+// below is made from the owning (e.g. UI) thread.
+struct SearchService {
+    SearchPool pool;
+    std::thread worker;
+    JobHandle current;
+    u64 nextId = 1;
+
+    explicit SearchService(int threads = 1, size_t hashMB = 64) : pool(threads) { pool.resizeHash(hashMB); }
+    ~SearchService(){ cancel(); }
+
+    SearchService(const SearchService&) = delete;
+    SearchService& operator=(const SearchService&) = delete;
+
+    // Starts searching bd (history: hashes of the game positions before it, oldest first).
+    // A job still running is cancelled first.
+    JobHandle submit(const Board& bd, std::vector<u64> history, int maxDepth, const TimeBudget& budget);
+
+    // Raises the stop flag and waits for the search thread; the search polls the flag every
+    // few thousand nodes, so this returns within milliseconds. The job, if any, finishes
+    // with cancelled = true.
+    void cancel();
+
+    // Pondering: submit the expected position with an unlimited TimeBudget while the
+    // opponent thinks. If they play the expected move, ponderHit() turns that search into
+    // the real one, with the budget starting now and the TT, iteration and move ordering
+    // state carried over; otherwise cancel() it.
+    void ponderHit(const TimeBudget& budget);
+
+    bool busy() const { return current && !current->finished.load(std::memory_order_acquire); }
+
+    // Pool configuration; each cancels the running job first.
+    void newGame(){ cancel(); pool.newGame(); }
+    void clearHash(){ cancel(); pool.clearHash(); }
+    void setThreads(int n){ cancel(); if(n != pool.threadCount()) pool.setThreads(n); }
+    int threadCount() const { return pool.threadCount(); }
+    void setHashMB(size_t mb){ cancel(); if(mb != pool.tt.sizeMB()) pool.resizeHash(mb); }
+    size_t hashMB() const { return pool.tt.sizeMB(); }
+};
@@ -0,0 +1,35 @@
+// engine/spsc_queue.h  (bounded lock-free single-producer / single-consumer queue)
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+// Ring buffer of N slots (a power of two). Exactly one thread may push and one other
+// thread may pop; neither ever blocks. The indices only grow, so full and empty are told
+// apart without a spare slot, and each lives on its own cache line.
+template<class T, size_t N>
+struct SpscQueue {
+    static_assert(N && (N & (N-1))==0, "capacity must be a power of two");
+
+    T slots[N];
+    alignas(64) std::atomic<size_t> head{0};   // next slot to pop, written by the consumer
+    alignas(64) std::atomic<size_t> tail{0};   // next slot to push, written by the producer
+
+    // False if the queue is full; the item is dropped.
+    bool push(const T& v){
+        size_t t = tail.load(std::memory_order_relaxed);
+        if(t - head.load(std::memory_order_acquire) == N) return false;
+        slots[t & (N-1)] = v;
+        tail.store(t+1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T& out){
+        size_t h = head.load(std::memory_order_relaxed);
+        if(h == tail.load(std::memory_order_acquire)) return false;
+        out = std::move(slots[h & (N-1)]);
+        head.store(h+1, std::memory_order_release);
+        return true;
+    }
+};
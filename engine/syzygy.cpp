@@ -0,0 +1,84 @@
+// engine/syzygy.cpp
+#include "syzygy.h"
+
+#ifdef ORRYX_SYZYGY
+
+#include "tbprobe.h"
+
+// Fathom takes the position as bitboards with the same a1=0 square numbering as ours.
+struct FathomPos {
+    u64 white, black, kings, queens, rooks, bishops, knights, pawns;
+    unsigned ep;
+    bool whiteToMove;
+};
+
+static FathomPos toFathom(const Board& bd){
+    auto both = [&](PieceType t){ return bd.piecesOf(Color::White, t) | bd.piecesOf(Color::Black, t); };
+    FathomPos p;
+    p.white   = bd.occ[0];
+    p.black   = bd.occ[1];
+    p.kings   = both(PieceType::King);
+    p.queens  = both(PieceType::Queen);
+    p.rooks   = both(PieceType::Rook);
+    p.bishops = both(PieceType::Bishop);
+    p.knights = both(PieceType::Knight);
+    p.pawns   = both(PieceType::Pawn);
+    p.ep = (bd.epSquare >= 0) ? unsigned(bd.epSquare) : 0u;
+    p.whiteToMove = (bd.stm == Color::White);
+    return p;
+}
+
+static TBWdl fromFathomWdl(unsigned wdl){
+    if(wdl == TB_WIN) return TBWdl::Win;
+    if(wdl == TB_LOSS) return TBWdl::Loss;
+    return TBWdl::Draw;   // draw, cursed win, blessed loss
+}
+
+bool tbInit(const std::string& path){
+    if(path.empty()){ tb_free(); return false; }
+    return tb_init(path.c_str()) && TB_LARGEST > 0;
+}
+
+int tbLargest(){ return (int)TB_LARGEST; }
+
+bool tbProbeWDL(const Board& bd, TBWdl& wdl){
+    if(bd.castling || bd.halfmoveClock || popcount(bd.occupied()) > (int)TB_LARGEST) return false;
+    FathomPos p = toFathom(bd);
+    unsigned r = tb_probe_wdl(p.white, p.black, p.kings, p.queens, p.rooks, p.bishops, p.knights, p.pawns,
+                              0, 0, p.ep, p.whiteToMove);
+    if(r == TB_RESULT_FAILED) return false;
+    wdl = fromFathomWdl(r);
+    return true;
+}
+
+bool tbProbeRoot(const Board& bd, Move& move, TBWdl& wdl){
+    if(bd.castling || popcount(bd.occupied()) > (int)TB_LARGEST) return false;
+    FathomPos p = toFathom(bd);
+    unsigned r = tb_probe_root(p.white, p.black, p.kings, p.queens, p.rooks, p.bishops, p.knights, p.pawns,
+                               (unsigned)bd.halfmoveClock, 0, p.ep, p.whiteToMove, nullptr);
+    if(r == TB_RESULT_FAILED || r == TB_RESULT_CHECKMATE || r == TB_RESULT_STALEMATE) return false;
+
+    static const PieceType PROMO[5] = { PieceType::None, PieceType::Queen, PieceType::Rook, PieceType::Bishop, PieceType::Knight };
+    int from = (int)TB_GET_FROM(r), to = (int)TB_GET_TO(r);
+    PieceType promo = PROMO[TB_GET_PROMOTES(r)];
+
+    MoveList legal;
+    bd.genLegalMoves(legal);
+    for(const Move& m : legal){
+        if(m.from==from && m.to==to && m.promo==promo){
+            move = m;
+            wdl = fromFathomWdl(TB_GET_WDL(r));
+            return true;
+        }
+    }
+    return false;
+}
+
+#else
+
+bool tbInit(const std::string&){ return false; }
+int tbLargest(){ return 0; }
+bool tbProbeWDL(const Board&, TBWdl&){ return false; }
+bool tbProbeRoot(const Board&, Move&, TBWdl&){ return false; }
+
+#endif
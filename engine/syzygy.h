@@ -0,0 +1,28 @@
+// engine/syzygy.h  (Syzygy endgame tablebases, probed through Fathom)
+#pragma once
+
+#include "board.h"
+
+#include <string>
+
+// Probing is compiled in only with ORRYX_SYZYGY (see scripts/build_engine.sh: FATHOM_DIR).
+// Without it every function below reports "no tables", so callers need no #ifdefs.
+
+// Loads the tables under path (directories separated by ':' on Linux/macOS). An empty path
+// unloads them. Returns false if nothing could be loaded. Call only while no search is running.
+bool tbInit(const std::string& path);
+
+// Largest piece count covered by the loaded tables (0 = none loaded).
+int tbLargest();
+
+enum class TBWdl : u8 { Loss, Draw, Win };
+
+// Win/draw/loss for the side to move. Fails (returns false) unless the position is covered,
+// has no castling rights and halfmoveClock is 0 (right after a capture or pawn move), as
+// WDL tables don't track the 50-move counter. Cursed wins and blessed losses are draws.
+// Thread-safe.
+bool tbProbeWDL(const Board& bd, TBWdl& wdl);
+
+// Root probe with DTZ: the move that keeps the best result while respecting the 50-move
+// rule, and that result. Not thread-safe: call from one thread, before helpers start.
+bool tbProbeRoot(const Board& bd, Move& move, TBWdl& wdl);
@@ -0,0 +1,38 @@
+// engine/timeman.cpp
+#include "timeman.h"
+
+#include <algorithm>
+
+TimeBudget allocateTime(int remainingMs, int incMs, int movesToGo){
+    int mtg = (movesToGo > 0) ? std::min(movesToGo, 50) : 30;
+    int safe = std::max(1, remainingMs - MOVE_OVERHEAD_MS);
+
+    // Target: an even share of the remaining time plus most of the increment. Iterations
+    // grow geometrically, so stopping new ones at half the target lands near it on average;
+    // the hard limit leaves room for an unstable search, but never more than a third of
+    // the clock unless this is the last move before the time control.
+    int target = std::max(1, std::min(remainingMs / mtg + incMs * 3 / 4, safe));
+    TimeBudget b;
+    b.softMs = std::max(1, target / 2);
+    b.hardMs = std::max(b.softMs, std::min(target * 2, movesToGo==1 ? safe : safe / 3));
+    return b;
+}
+
+int TimeManager::scaledSoftLimit(int softMs, const Move& best, int score){
+    static const double STABILITY_SCALE[5] = { 1.6, 1.25, 1.0, 0.85, 0.75 };
+
+    bool changed = !(best.from==lastBest.from && best.to==lastBest.to && best.promo==lastBest.promo);
+    double scale = 1.0;
+    if(!first){
+        stableIterations = changed ? 0 : stableIterations + 1;
+        scale = STABILITY_SCALE[std::min(stableIterations, 4)];
+        int drop = lastScore - score;
+        if(drop > 0) scale *= 1.0 + std::min(drop, 100) / 200.0;
+    }
+    first = false;
+    lastBest = best;
+    lastScore = score;
+
+    if(softMs == INT_MAX) return INT_MAX;
+    return (int)std::min<double>(softMs * scale, INT_MAX);
+}
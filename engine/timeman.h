@@ -0,0 +1,45 @@
+// engine/timeman.h  (per-move time budgets and iteration stop decisions)
+#pragma once
+
+#include "types.h"
+
+#include <algorithm>
+#include <climits>
+
+// softMs: no new iteration is started past this point (stretched or shrunk by how settled
+// the search looks). hardMs: the search is aborted mid-iteration. INT_MAX = no limit.
+struct TimeBudget {
+    int softMs = INT_MAX;
+    int hardMs = INT_MAX;
+
+    // Exactly ms to think (UCI movetime, the GUI's think time): no early stop.
+    static TimeBudget fixed(int ms){ return TimeBudget{INT_MAX, ms}; }
+    bool limited() const { return hardMs != INT_MAX; }
+
+    // The same budget for a search that has already run elapsedMs (ponderhit: the clock
+    // starts now, the time spent pondering comes on top).
+    TimeBudget shiftedBy(int elapsedMs) const {
+        auto shift = [&](int ms){ return (ms==INT_MAX) ? INT_MAX : (int)std::min<long long>((long long)ms + elapsedMs, INT_MAX); };
+        return TimeBudget{shift(softMs), shift(hardMs)};
+    }
+};
+
+// Kept back from the remaining time for GUI and transport lag.
+constexpr int MOVE_OVERHEAD_MS = 50;
+
+// Budget for one move from the clock. movesToGo = moves until the next time control,
+// 0 for sudden death.
+TimeBudget allocateTime(int remainingMs, int incMs, int movesToGo);
+
+// Follows the best move and score across the iterations of one search.
+struct TimeManager {
+    Move lastBest{};
+    int lastScore = 0;
+    int stableIterations = 0;
+    bool first = true;
+
+    // Called after every completed iteration with its result; returns the soft limit to
+    // test against: longer while the best move keeps changing or the score is falling,
+    // shorter once it has held for a few iterations.
+    int scaledSoftLimit(int softMs, const Move& best, int score);
+};
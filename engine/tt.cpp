@@ -0,0 +1,114 @@
+// engine/tt.cpp
+#include "tt.h"
+
+#include <cstdlib>
+#include <new>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace {
+
+constexpr size_t HUGE_PAGE = 2ull << 20;
+
+void* alignedAlloc(size_t align, size_t bytes){
+#if defined(_WIN32)
+    return _aligned_malloc(bytes, align);
+#else
+    void* p = nullptr;
+    return posix_memalign(&p, align, bytes)==0 ? p : nullptr;
+#endif
+}
+
+void alignedFree(void* p){
+#if defined(_WIN32)
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+// (Re)constructs every bucket, which zeroes it. Split into slices over threads; for a fresh
+// table this is also the first touch, so the pages get faulted in in parallel too.
+void fillBuckets(TTBucket* t, size_t n, int threads){
+    constexpr size_t MIN_SLICE = 1 << 16;   // 4 MB: below that a thread costs more than it saves
+    size_t maxThreads = std::max<size_t>(1, n / MIN_SLICE);
+    size_t parts = std::min<size_t>(std::max(1, threads), maxThreads);
+    size_t slice = (n + parts - 1) / parts;
+    auto work = [t, n, slice](size_t part){
+        size_t end = std::min(n, (part + 1) * slice);
+        for(size_t i = part * slice; i < end; i++) new (&t[i]) TTBucket();
+    };
+    std::vector<std::thread> helpers;
+    for(size_t p = 1; p < parts; p++) helpers.emplace_back(work, p);
+    work(0);
+    for(auto& h : helpers) h.join();
+}
+
+} // namespace
+
+void TranspositionTable::release(){
+    if(!table) return;
+#if defined(__linux__)
+    if(memory==TTMemory::HugeTLB) munmap(table, allocatedBytes);
+    else
+#endif
+    alignedFree(table);
+    table = nullptr;
+    buckets = 0;
+    allocatedBytes = 0;
+    memory = TTMemory::None;
+}
+
+void TranspositionTable::resizeMB(size_t mb, int threads){
+    release();
+    generation = 0;
+    if(mb==0) return;
+
+    size_t n = std::max<size_t>(1, mb*1024ull*1024ull / sizeof(TTBucket));
+    size_t bytes = n * sizeof(TTBucket);
+    void* p = nullptr;
+
+#if defined(__linux__)
+    // Reserved huge pages first (MAP_HUGETLB fails at once if the pool is too small), then
+    // transparent huge pages on a 2 MB aligned block.
+    if(largePages && bytes >= HUGE_PAGE){
+        size_t rounded = (bytes + HUGE_PAGE - 1) & ~(HUGE_PAGE - 1);
+        p = mmap(nullptr, rounded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if(p != MAP_FAILED){
+            memory = TTMemory::HugeTLB;
+            allocatedBytes = rounded;
+        } else if((p = alignedAlloc(HUGE_PAGE, rounded))){
+            memory = (madvise(p, rounded, MADV_HUGEPAGE)==0) ? TTMemory::TransparentHuge : TTMemory::Aligned;
+            allocatedBytes = rounded;
+        }
+    }
+#endif
+    if(!p){
+        p = alignedAlloc(alignof(TTBucket), bytes);
+        if(!p) throw std::bad_alloc();
+        memory = TTMemory::Aligned;
+        allocatedBytes = bytes;
+    }
+
+    table = static_cast<TTBucket*>(p);
+    buckets = n;
+    fillBuckets(table, buckets, threads);
+}
+
+void TranspositionTable::clear(int threads){
+    if(table) fillBuckets(table, buckets, threads);
+    generation = 0;
+}
+
+const char* TranspositionTable::memoryName() const {
+    switch(memory){
+        case TTMemory::HugeTLB: return "huge pages";
+        case TTMemory::TransparentHuge: return "transparent huge pages";
+        case TTMemory::Aligned: return "normal pages";
+        default: return "none";
+    }
+}
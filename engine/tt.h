@@ -0,0 +1,162 @@
+// engine/tt.h  (transposition table shared by all search threads)
+#pragma once
+
+#include "board.h"
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstddef>
+
+enum class TTFlag : u8 { Exact=0, Lower=1, Upper=2 };
+
+// 16-bit move encoding for the TT: from:6 | to:6 | kind:2 | promo:2.
+// kind 0=normal 1=promotion 2=en passant 3=castle; promo 0..3 = N,B,R,Q.
+// The capture flag is recovered from the board when decoding (see decodeMove).
+inline u16 encodeMove(const Move& m){
+    u16 kind = (m.promo!=PieceType::None) ? 1 : m.isEnPassant ? 2 : m.isCastle ? 3 : 0;
+    u16 promo = (m.promo!=PieceType::None) ? u16(int(m.promo) - int(PieceType::Knight)) : 0;
+    return u16(m.from) | u16(m.to << 6) | u16(kind << 12) | u16(promo << 14);
+}
+
+inline Move decodeMove(u16 v, const Board& bd){
+    Move m;
+    if(v==0) return m;
+    m.from = u8(v & 63);
+    m.to = u8((v >> 6) & 63);
+    int kind = (v >> 12) & 3;
+    if(kind==1) m.promo = PieceType(int(PieceType::Knight) + (v >> 14));
+    m.isEnPassant = (kind==2);
+    m.isCastle = (kind==3);
+    m.isCapture = m.isEnPassant || !isNone(bd.at(m.to));
+    return m;
+}
+
+// Unpacked copy of an entry. probe() hands out copies so readers never hold a pointer
+// into a slot that another thread may be overwriting.
+struct TTData {
+    u16 move=0;
+    int score=0;
+    int depth=0;
+    TTFlag flag=TTFlag::Exact;
+    int age=0;
+};
+
+// Shared by all search threads without locks ("XOR trick"): the key is stored xor'ed
+// with the packed payload, so a slot torn by a concurrent write simply fails the key
+// check rather than returning another position's data.
+struct TTEntry {
+    std::atomic<u64> check{0};   // key ^ data
+    std::atomic<u64> data{0};    // move:16 | score:16 | depth:8 | flag:2 | age:6
+};
+
+inline u64 packTT(u16 move, int score, int depth, TTFlag flag, int age){
+    return u64(move)
+         | (u64(u16(int16_t(score))) << 16)
+         | (u64(u8(depth)) << 32)
+         | (u64(flag) << 40)
+         | (u64(age & 63) << 42);
+}
+inline TTData unpackTT(u64 d){
+    TTData t;
+    t.move = u16(d);
+    t.score = int16_t(u16(d >> 16));
+    t.depth = u8(d >> 32);
+    t.flag = TTFlag(u8(d >> 40) & 3);
+    t.age = int(u8(d >> 42) & 63);
+    return t;
+}
+
+// Four 16-byte entries share one 64-byte cache line, so a probe costs a single miss.
+constexpr int TT_BUCKET_SIZE = 4;
+struct alignas(64) TTBucket {
+    TTEntry e[TT_BUCKET_SIZE];
+};
+static_assert(sizeof(TTEntry) == 16, "TT entries are packed to 16 bytes");
+static_assert(sizeof(TTBucket) == 64, "a TT bucket must fill exactly one cache line");
+
+// Where the table memory came from. Huge pages cut the TLB misses of random probes into a
+// large table; they are only tried for tables of at least one 2 MB page.
+enum class TTMemory : u8 { None, Aligned, TransparentHuge, HugeTLB };
+
+// Lives as long as the engine: entries survive from one move to the next, and each search
+// bumps the generation so entries left by older searches are the first to be replaced.
+struct TranspositionTable {
+    TTBucket* table=nullptr;        // 64-byte aligned, one bucket per cache line
+    size_t buckets=0;               // any count: bucket() maps the key onto it by multiply-shift
+    size_t allocatedBytes=0;
+    TTMemory memory=TTMemory::None;
+    bool largePages=true;           // try huge pages on the next resize
+    int generation=0;               // 6-bit search age stamped into every store
+
+    TranspositionTable() = default;
+    ~TranspositionTable(){ release(); }
+    TranspositionTable(const TranspositionTable&) = delete;
+    TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+    // Exactly mb megabytes (no rounding to a power of two); 0 frees the table. The new
+    // table is zeroed, and clear() zeroes it again, by threads threads.
+    void resizeMB(size_t mb, int threads=1);
+    void clear(int threads=1);
+    void release();
+
+    size_t sizeMB() const { return buckets * sizeof(TTBucket) >> 20; }
+    const char* memoryName() const;
+
+    void newSearch(){ generation = (generation + 1) & 63; }
+
+    // High half of key * buckets: uniform over [0, buckets) for any bucket count, and as
+    // cheap as a mask. The index comes from the top key bits, the full key is checked.
+    TTBucket& bucket(u64 key) const {
+        return table[size_t((unsigned __int128)key * buckets >> 64)];
+    }
+
+    // Issued right after makeMove so the child's bucket is on its way while the child
+    // does its repetition/draw checks.
+    void prefetch(u64 key) const {
+        if(table) __builtin_prefetch(&bucket(key));
+    }
+
+    bool probe(u64 key, TTData& out) const {
+        if(!table) return false;
+        for(const TTEntry& e : bucket(key).e){
+            u64 d = e.data.load(std::memory_order_relaxed);
+            u64 c = e.check.load(std::memory_order_relaxed);
+            if((c ^ d) == key){
+                out = unpackTT(d);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void store(u64 key, int depth, int score, TTFlag flag, u16 move){
+        if(!table) return;
+        TTBucket& b = bucket(key);
+
+        // Same position wins; otherwise evict the least valuable slot, where every search
+        // of age costs an entry 8 plies of depth (empty slots have depth 0 and go first).
+        TTEntry* victim = nullptr;
+        TTData victimData;
+        int victimWorth = INT_MAX;
+        bool sameKey = false;
+        for(TTEntry& e : b.e){
+            u64 d = e.data.load(std::memory_order_relaxed);
+            u64 c = e.check.load(std::memory_order_relaxed);
+            TTData t = unpackTT(d);
+            if((c ^ d) == key){
+                victim = &e; victimData = t; sameKey = true;
+                break;
+            }
+            int worth = (d==0 && c==0) ? INT_MIN : t.depth - 8*((generation - t.age) & 63);
+            if(worth < victimWorth){
+                victim = &e; victimData = t; victimWorth = worth;
+            }
+        }
+
+        if(sameKey && move==0) move = victimData.move;
+        u64 d = packTT(move, std::clamp(score, -32767, 32767), std::clamp(depth, 0, 127), flag, generation);
+        victim->data.store(d, std::memory_order_relaxed);
+        victim->check.store(key ^ d, std::memory_order_relaxed);
+    }
+};
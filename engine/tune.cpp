@@ -0,0 +1,272 @@
+// engine/tune.cpp
+#include "tune.h"
+#include "search.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <thread>
+
+std::vector<int> evalWeights(){
+    std::vector<int> w(EP_COUNT, 0);
+    for(int t=0;t<7;t++) w[EP_PIECE + t] = PIECE_VALUE[t];
+    const int* tables[7] = { PST_PAWN, PST_KNIGHT, PST_BISHOP, PST_ROOK, PST_QUEEN, PST_KING_MG, PST_KING_EG };
+    for(int t=0;t<7;t++)
+        for(int sq=0;sq<64;sq++) w[EP_PST + t*64 + sq] = tables[t][sq];
+    w[EP_BISHOP_PAIR] = BISHOP_PAIR;
+    w[EP_DOUBLED] = DOUBLED_PAWN;
+    w[EP_ISOLATED] = ISOLATED_PAWN;
+    w[EP_MOBILITY] = MOBILITY;
+    for(int b=0;b<3;b++) w[EP_KING_CENTRE + b] = KING_CENTRE[b];
+    w[EP_NO_CASTLING] = NO_CASTLING;
+    return w;
+}
+
+void writeEvalParams(std::ostream& os, const std::vector<int>& w){
+    auto list = [&](int first, int n){
+        std::string s;
+        for(int i=0;i<n;i++) s += (i ? ", " : "") + std::to_string(w[first + i]);
+        return s;
+    };
+    os << "// engine/evalparams.h  (evaluation weights written by `tune`; the format is fixed)\n"
+       << "#pragma once\n\n"
+       << "// Piece values, used by the evaluation and by SEE / move ordering. Index: None, P, N, B, R, Q, K.\n"
+       << "inline constexpr int PIECE_VALUE[7] = { " << list(EP_PIECE, 7) << " };\n\n"
+       << "// Piece-square tables, indexed by square (a1 = 0) for White; Black's pieces use the mirrored square.\n";
+    static const char* NAMES[7] = { "PST_PAWN", "PST_KNIGHT", "PST_BISHOP", "PST_ROOK", "PST_QUEEN", "PST_KING_MG", "PST_KING_EG" };
+    for(int t=0;t<7;t++){
+        os << "inline constexpr int " << NAMES[t] << "[64] = {\n";
+        for(int r=0;r<8;r++){
+            os << "  ";
+            for(int f=0;f<8;f++){
+                char buf[16];
+                std::snprintf(buf, sizeof(buf), "%4d", w[EP_PST + t*64 + r*8 + f]);
+                os << buf << ((r==7 && f==7) ? "" : ",");
+            }
+            os << "\n";
+        }
+        os << "};\n";
+    }
+    os << "\n"
+       << "inline constexpr int BISHOP_PAIR = " << w[EP_BISHOP_PAIR] << ";\n"
+       << "inline constexpr int DOUBLED_PAWN = " << w[EP_DOUBLED] << ";          // per extra pawn on a file\n"
+       << "inline constexpr int ISOLATED_PAWN = " << w[EP_ISOLATED] << ";         // per file with pawns and no neighbours\n"
+       << "inline constexpr int MOBILITY = " << w[EP_MOBILITY] << ";               // per reachable square\n"
+       << "inline constexpr int KING_CENTRE[3] = { " << list(EP_KING_CENTRE, 3) << " };   // king on the d-f files, 0/1/2 ranks from an edge; middlegame only\n"
+       << "inline constexpr int NO_CASTLING = " << w[EP_NO_CASTLING] << ";           // both castling rights gone, middlegame only\n";
+}
+
+namespace {
+
+// FEN (4 fields, plus the move counters if present) and the result, White's view.
+bool parseTuneLine(const std::string& line, std::string& fen, double& result){
+    std::istringstream is(line);
+    std::string f[6];
+    int n = 0;
+    while(n < 6 && is >> f[n]) n++;
+    if(n < 4 || f[0][0]=='#') return false;
+    bool counters = n==6 && std::isdigit((unsigned char)f[4][0]) && std::isdigit((unsigned char)f[5][0]);
+    fen = f[0] + " " + f[1] + " " + f[2] + " " + f[3] + (counters ? " " + f[4] + " " + f[5] : "");
+
+    std::istringstream skip(line);
+    std::string token;
+    for(int i=0;i<4;i++) skip >> token;
+    size_t rest = (size_t)skip.tellg();
+    if(line.find("1/2-1/2", rest) != std::string::npos) result = 0.5;
+    else if(line.find("1-0", rest) != std::string::npos) result = 1.0;
+    else if(line.find("0-1", rest) != std::string::npos) result = 0.0;
+    else {
+        size_t b = line.find('[', rest);
+        if(b == std::string::npos) return false;
+        result = std::atof(line.c_str() + b + 1);
+    }
+    return result >= 0.0 && result <= 1.0;
+}
+
+double sigmoid(double k, double q){ return 1.0 / (1.0 + std::pow(10.0, -k * q / 400.0)); }
+
+struct Line {
+    std::string fen;
+    double result;
+};
+
+// Per thread: a search context for the quiescence searches, and what the slice adds up to.
+struct TuneWorker {
+    std::unique_ptr<SearchContext> ctx = std::make_unique<SearchContext>();
+    std::vector<EvalCoef> coefs;
+    std::vector<double> grad = std::vector<double>(EP_COUNT);
+    double loss = 0.0;
+    int count = 0;
+    int mismatches = 0;          // trace disagreed with evaluate (checked on the first batch)
+
+    TuneWorker(){ ctx->start = std::chrono::steady_clock::now(); }
+
+    // q of line's quiet position under weights w (White's view); false for unusable lines.
+    bool score(const Zobrist& zob, const Line& line, const std::vector<double>& w, double& q, bool check){
+        Board bd, leaf;
+        bd.setZobrist(&zob);
+        if(!bd.setFen(line.fen)) return false;
+        quiescenceLeaf(bd, *ctx, leaf);
+        evalTrace(leaf, coefs);
+        q = 0.0;
+        for(const EvalCoef& c : coefs) q += c.coef * w[c.param];
+        if(check){
+            int compiled = evaluate(leaf, nullptr);
+            if(leaf.stm==Color::Black) compiled = -compiled;
+            int traced = 0;
+            std::vector<int> cw = evalWeights();
+            for(const EvalCoef& c : coefs) traced += c.coef * cw[c.param];
+            if(traced != compiled) mismatches++;
+        }
+        return true;
+    }
+};
+
+template<class F>
+void parallelFor(std::vector<TuneWorker>& workers, int n, F f){
+    int t = (int)workers.size();
+    std::vector<std::thread> pool;
+    for(int i=1;i<t;i++) pool.emplace_back([&, i](){ for(int j=i;j<n;j+=t) f(workers[i], j); });
+    for(int j=0;j<n;j+=t) f(workers[0], j);
+    for(auto& th : pool) th.join();
+}
+
+// Reads up to n usable lines; false once the file is exhausted and nothing was read.
+bool readBatch(std::istream& in, int n, std::vector<Line>& out){
+    out.clear();
+    std::string s;
+    Line l;
+    while((int)out.size() < n && std::getline(in, s))
+        if(parseTuneLine(s, l.fen, l.result)) out.push_back(l);
+    return !out.empty();
+}
+
+} // namespace
+
+bool runTune(const TuneConfig& cfg, std::ostream& log){
+    std::ifstream in(cfg.dataPath);
+    if(!in){
+        log << "cannot read " << cfg.dataPath << "\n";
+        return false;
+    }
+
+    // The tuned terms are the hand-written ones, whatever network is loaded.
+    EvalConfig savedEval = evalConfig;
+    evalConfig.nnue = false;
+
+    Zobrist zob;
+    std::vector<TuneWorker> workers(std::max(1, cfg.threads));
+    std::vector<int> start = evalWeights();
+    std::vector<double> w(start.begin(), start.end());
+    std::vector<Line> batch;
+
+    // Fit k to the untuned weights on the first batches (at most 16 in memory, as scores).
+    double k = cfg.k;
+    if(k <= 0.0){
+        std::vector<double> qs, rs;
+        for(int b=0; b<16 && readBatch(in, cfg.batch, batch); b++){
+            std::vector<double> q(batch.size());
+            std::vector<char> ok(batch.size());
+            parallelFor(workers, (int)batch.size(), [&](TuneWorker& wk, int i){
+                ok[i] = wk.score(zob, batch[i], w, q[i], b==0);
+            });
+            for(size_t i=0;i<batch.size();i++) if(ok[i]){ qs.push_back(q[i]); rs.push_back(batch[i].result); }
+        }
+        auto error = [&](double kk){
+            double e = 0.0;
+            for(size_t i=0;i<qs.size();i++){ double d = rs[i] - sigmoid(kk, qs[i]); e += d*d; }
+            return qs.empty() ? 0.0 : e / qs.size();
+        };
+        double lo = 0.0, hi = 5.0;
+        for(int it=0; it<60; it++){
+            double m1 = lo + (hi-lo)/3, m2 = hi - (hi-lo)/3;
+            if(error(m1) < error(m2)) hi = m2; else lo = m1;
+        }
+        k = (lo + hi) / 2;
+        int mismatches = 0;
+        for(const TuneWorker& wk : workers) mismatches += wk.mismatches;
+        log << "k = " << k << " (fitted on " << qs.size() << " positions, error " << error(k) << ")\n";
+        if(mismatches) log << "warning: evalTrace disagrees with evaluate on " << mismatches << " positions\n";
+        if(qs.empty()){
+            log << "no usable positions in " << cfg.dataPath << "\n";
+            evalConfig = savedEval;
+            return false;
+        }
+    }
+
+    // The pawn anchors the centipawn scale and the king's value never enters the score.
+    auto frozen = [](int p){ return p==EP_PIECE || p==EP_PIECE + (int)PieceType::Pawn || p==EP_PIECE + (int)PieceType::King; };
+
+    const double beta1 = 0.9, beta2 = 0.999, eps = 1e-8;
+    std::vector<double> m(EP_COUNT, 0.0), v(EP_COUNT, 0.0);
+    long long step = 0;
+    const double dq = k * std::log(10.0) / 400.0;
+
+    for(int epoch=1; epoch<=cfg.epochs; epoch++){
+        in.clear();
+        in.seekg(0);
+        auto t0 = std::chrono::steady_clock::now();
+        double epochLoss = 0.0;
+        long long epochCount = 0;
+
+        while(readBatch(in, cfg.batch, batch)){
+            for(TuneWorker& wk : workers){
+                std::fill(wk.grad.begin(), wk.grad.end(), 0.0);
+                wk.loss = 0.0;
+                wk.count = 0;
+            }
+            parallelFor(workers, (int)batch.size(), [&](TuneWorker& wk, int i){
+                double q;
+                if(!wk.score(zob, batch[i], w, q, false)) return;
+                double s = sigmoid(k, q);
+                double d = batch[i].result - s;
+                wk.loss += d*d;
+                wk.count++;
+                double g = -2.0 * d * s * (1.0 - s) * dq;
+                for(const EvalCoef& c : wk.coefs) wk.grad[c.param] += g * c.coef;
+            });
+
+            int n = 0;
+            std::vector<double> grad(EP_COUNT, 0.0);
+            for(const TuneWorker& wk : workers){
+                n += wk.count;
+                epochLoss += wk.loss;
+                for(int p=0;p<EP_COUNT;p++) grad[p] += wk.grad[p];
+            }
+            if(n==0) continue;
+            epochCount += n;
+
+            // Adam
+            step++;
+            for(int p=0;p<EP_COUNT;p++){
+                if(frozen(p)) continue;
+                double g = grad[p] / n;
+                m[p] = beta1*m[p] + (1-beta1)*g;
+                v[p] = beta2*v[p] + (1-beta2)*g*g;
+                double mh = m[p] / (1 - std::pow(beta1, double(step)));
+                double vh = v[p] / (1 - std::pow(beta2, double(step)));
+                w[p] -= cfg.learningRate * mh / (std::sqrt(vh) + eps);
+            }
+        }
+
+        long long ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t0).count();
+        log << "epoch " << epoch << ": error " << (epochCount ? epochLoss / epochCount : 0.0)
+            << " over " << epochCount << " positions, " << ms << " ms\n";
+
+        // Written after every epoch so a long run can be stopped at any point.
+        std::vector<int> rounded(EP_COUNT);
+        for(int p=0;p<EP_COUNT;p++) rounded[p] = (int)std::lround(w[p]);
+        std::ofstream out(cfg.outPath);
+        writeEvalParams(out, rounded);
+    }
+
+    log << "tuned weights written to " << cfg.outPath << "\n";
+    evalConfig = savedEval;
+    return true;
+}
@@ -0,0 +1,29 @@
+// engine/tune.h  (Texel tuning of the hand-written evaluation weights)
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+struct TuneConfig {
+    std::string dataPath;         // one FEN/EPD per line with the game result (White's view) anywhere
+                                  // after it: 1-0 / 0-1 / 1/2-1/2, or [1.0] / [0.5] / [0.0]
+    std::string outPath = "evalparams_tuned.h";
+    int threads = 1;
+    int epochs = 10;              // passes over the file
+    int batch = 16384;            // positions per gradient step; also all that is held in memory
+    double learningRate = 1.0;    // Adam step size, in centipawns
+    double k = 0.0;               // sigmoid scale; 0 = fit it on the first batches before tuning
+};
+
+// The compiled weights (evalparams.h) in EvalParam order.
+std::vector<int> evalWeights();
+
+// Writes weights as an evalparams.h replacement.
+void writeEvalParams(std::ostream& os, const std::vector<int>& w);
+
+// Minimises the mean squared error between each game result and sigmoid(k * q), where q is
+// the quiescence score of the position under the weights being tuned. The file is streamed
+// batch by batch, each batch split over cfg.threads. Progress goes to log; the final weights
+// go to cfg.outPath. Returns false if the data file can't be read or has no positions.
+bool runTune(const TuneConfig& cfg, std::ostream& log);
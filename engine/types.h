@@ -0,0 +1,109 @@
+// engine/types.h  (core chess types shared by the engine, GUI and UCI front end)
+#pragma once
+
+#include "evalparams.h"
+
+#include <cstdint>
+#include <string>
+
+using u8  = std::uint8_t;
+using u16 = std::uint16_t;
+using u32 = std::uint32_t;
+using u64 = std::uint64_t;
+
+// ======================== Squares / Coords ========================
+struct Square { int file=0, rank=0; }; // 0..7
+inline bool operator==(const Square& a, const Square& b){ return a.file==b.file && a.rank==b.rank; }
+inline bool inBounds(const Square& s){ return s.file>=0 && s.file<8 && s.rank>=0 && s.rank<8; }
+inline int sqToIndex(const Square& s){ return s.rank*8 + s.file; }
+inline Square indexToSq(int idx){ return Square{idx%8, idx/8}; }
+inline std::string sqName(const Square& s){
+    return std::string() + char('a'+s.file) + char('1'+s.rank);
+}
+
+// ======================== Chess Types ========================
+enum class Color : u8 { White=0, Black=1 };
+inline constexpr Color other(Color c){ return c==Color::White ? Color::Black : Color::White; }
+
+enum class PieceType : u8 { None=0, Pawn, Knight, Bishop, Rook, Queen, King };
+
+struct Piece {
+    PieceType t = PieceType::None;
+    Color c = Color::White;
+};
+inline bool isNone(const Piece& p){ return p.t==PieceType::None; }
+
+inline int pieceValue(PieceType t){ return PIECE_VALUE[(int)t]; }
+
+struct Move {
+    u8 from=0, to=0;
+    PieceType promo = PieceType::None;
+    bool isCapture=false;
+    bool isEnPassant=false;
+    bool isCastle=false;
+};
+
+// Fixed-capacity, stack-allocated move buffer so move generation never touches the heap.
+// 256 is above the known maximum of 218 legal moves in any position.
+struct MoveList {
+    static constexpr int CAPACITY = 256;
+    Move moves[CAPACITY];
+    int scores[CAPACITY];
+    int count = 0;
+
+    void clear(){ count = 0; }
+    void push_back(const Move& m){ moves[count++] = m; }
+    int size() const { return count; }
+    bool empty() const { return count==0; }
+
+    // Stable insertion sort, best score first (moves and scores stay paired).
+    void sortByScore(){
+        for(int i=1;i<count;i++){
+            Move m = moves[i];
+            int sc = scores[i];
+            int j = i-1;
+            while(j>=0 && scores[j] < sc){
+                moves[j+1] = moves[j];
+                scores[j+1] = scores[j];
+                j--;
+            }
+            moves[j+1] = m;
+            scores[j+1] = sc;
+        }
+    }
+
+    Move& operator[](int i){ return moves[i]; }
+    const Move& operator[](int i) const { return moves[i]; }
+    Move* begin(){ return moves; }
+    Move* end(){ return moves + count; }
+    const Move* begin() const { return moves; }
+    const Move* end() const { return moves + count; }
+};
+
+// Captures: captures, en passant and all promotions; Quiets: everything else; All: both.
+// Those are pseudo-legal. Evasions: the legal replies to a check (only used in check).
+enum class GenType : u8 { Captures, Quiets, All, Evasions };
+
+struct Undo {
+    Move m{};
+    Piece captured{};
+    int epSquare=-1;
+    u8 castling=0;
+    int halfmoveClock=0;
+    u64 hash=0;
+    u64 pawnKey=0;
+};
+
+inline std::string moveToUCI(const Move& m){
+    Square a = indexToSq(m.from);
+    Square b = indexToSq(m.to);
+    std::string s = sqName(a) + sqName(b);
+    if(m.promo!=PieceType::None){
+        char pc='q';
+        if(m.promo==PieceType::Rook) pc='r';
+        if(m.promo==PieceType::Bishop) pc='b';
+        if(m.promo==PieceType::Knight) pc='n';
+        s.push_back(pc);
+    }
+    return s;
+}
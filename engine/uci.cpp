@@ -0,0 +1,645 @@
+// engine/uci.cpp
+#include "uci.h"
+#include "bench.h"
+#include "book.h"
+#include "epd.h"
+#include "match.h"
+#include "perft.h"
+#include "search.h"
+#include "syzygy.h"
+#include "tune.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace {
+
+const char* ENGINE_NAME   = "Orryx";
+const char* ENGINE_AUTHOR = "tiraaamisuuu";
+const int DEFAULT_HASH_MB = 64;
+const int MAX_HASH_MB     = 65536;
+const int MAX_THREADS     = 256;
+
+// Standard perft positions with their published leaf counts.
+struct PerftCase { const char* fen; int depth; u64 nodes; };
+const PerftCase PERFT_SUITE[] = {
+    { "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",                 6, 119060324ULL },
+    { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",     5, 193690690ULL },
+    { "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",                                 6,  11030083ULL },
+    { "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",         5,  15833292ULL },
+    { "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",                 4,   2103487ULL },
+    { "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",  4,   3894594ULL },
+};
+
+// Polyglot keys published with the book format, after the given moves from the start.
+struct BookKeyCase { const char* moves; u64 key; };
+const BookKeyCase BOOK_KEY_SUITE[] = {
+    { "",                               PolyglotBook::START_KEY },
+    { "e2e4",                           0x823C9B50FD114196ULL },
+    { "e2e4 d7d5",                      0x0756B94461C50FB0ULL },
+    { "e2e4 d7d5 e4e5",                 0x662FAFB965DB29D4ULL },
+    { "e2e4 d7d5 e4e5 f7f5",            0x22A48B5A8E47FF78ULL },
+    { "e2e4 d7d5 e4e5 f7f5 e1e2",       0x652A607CA3F242C1ULL },
+    { "e2e4 d7d5 e4e5 f7f5 e1e2 e8f7",  0x00FDD303C946BDD9ULL },
+    { "a2a4 b7b5 h2h4 b5b4 c2c4",       0x3C8123EA7B067637ULL },
+    { "a2a4 b7b5 h2h4 b5b4 c2c4 b4c3 a1a3", 0x5C3F9B829B279560ULL },
+};
+
+u64 nodesPerSecond(u64 nodes, long long ms){
+    return ms > 0 ? u64(double(nodes) * 1000.0 / double(ms)) : nodes;
+}
+
+std::string scoreToUCI(int score){
+    if(score >= MATE_BOUND) return "mate " + std::to_string((MATE - score + 1) / 2);
+    if(score <= -MATE_BOUND) return "mate " + std::to_string(-(MATE + score) / 2);
+    return "cp " + std::to_string(score);
+}
+
+struct UciEngine;
+
+// Hands what a long-running command logs to UciEngine::send line by line, as it comes.
+struct SendBuf : std::streambuf {
+    UciEngine& e;
+    std::string line;
+    explicit SendBuf(UciEngine& eng) : e(eng) {}
+    int overflow(int c) override;
+};
+
+struct UciEngine {
+    std::ostream& out;
+    std::mutex outMutex;
+
+    Zobrist zob;
+    Board board;
+    std::vector<u64> history;   // hashes of the positions before board since the last irreversible move
+    SearchPool pool;
+
+    // The search runs on its own thread so "stop", "ponderhit" and "isready" are
+    // answered while it thinks.
+    std::thread searchThread;
+    std::mutex holdMutex;
+    std::condition_variable holdCv;
+    bool holdBestMove = false;   // go infinite / go ponder: bestmove waits for stop or ponderhit
+    bool pondering = false;
+    bool infinite = false;
+    TimeBudget ponderBudget;     // time to spend once the ponder move is played
+    std::string statsPath;       // ORRYX_STATS builds: search profiles are appended here as JSON lines
+
+    explicit UciEngine(std::ostream& o) : out(o) {
+        board.setZobrist(&zob);
+        board.reset();
+        pool.resizeHash(DEFAULT_HASH_MB);
+    }
+    ~UciEngine(){ stopSearch(); }
+
+    void send(const std::string& line){
+        std::lock_guard<std::mutex> lock(outMutex);
+        out << line << std::endl;
+    }
+
+    // ORRYX_STATS builds: the profile as info strings, and as a JSON line in StatsFile.
+    void reportProfile(const char* what, int depth, u64 nodes, long long ms, const SearchProfile& p){
+        if(!SEARCH_PROFILING) return;
+        std::istringstream lines(searchProfileReport(p));
+        std::string line;
+        while(std::getline(lines, line)) send("info string " + line);
+        if(statsPath.empty()) return;
+        std::ofstream f(statsPath, std::ios::app);
+        f << "{\"" << what << "\":{\"depth\":" << depth << ",\"nodes\":" << nodes << ",\"timeMs\":" << ms << "},\"profile\":";
+        writeSearchProfileJSON(f, p);
+        f << "}\n";
+    }
+
+    void stopSearch(){
+        if(!searchThread.joinable()) return;
+        pool.stopSearch();
+        {
+            std::lock_guard<std::mutex> lock(holdMutex);
+            holdBestMove = false;
+            pondering = false;
+        }
+        holdCv.notify_all();
+        searchThread.join();
+    }
+
+    void position(std::istringstream& is){
+        std::string token;
+        is >> token;
+        Board nb = board;
+        std::vector<u64> hist;
+        if(token=="startpos"){
+            nb.reset();
+            is >> token;
+        } else if(token=="fen"){
+            std::string fen, part;
+            while(is >> part && part!="moves") fen += (fen.empty() ? "" : " ") + part;
+            if(!nb.setFen(fen)){
+                send("info string invalid fen: " + fen);
+                return;
+            }
+            token = part;
+        } else {
+            return;
+        }
+
+        if(token=="moves"){
+            while(is >> token){
+                std::optional<Move> m = moveFromUCI(nb, token);
+                if(!m){
+                    send("info string illegal move: " + token);
+                    break;
+                }
+                hist.push_back(nb.hash);
+                Undo u{};
+                nb.makeMove(*m, u);
+                if(nb.halfmoveClock==0) hist.clear();
+            }
+        }
+        board = nb;
+        history = std::move(hist);
+    }
+
+    void go(std::istringstream& is){
+        stopSearch();
+
+        int wtime=-1, btime=-1, winc=0, binc=0, movesToGo=0, moveTime=-1, depth=-1;
+        long long nodes=0;
+        bool inf=false, ponder=false;
+        std::string token;
+        while(is >> token){
+            if(token=="wtime") is >> wtime;
+            else if(token=="btime") is >> btime;
+            else if(token=="winc") is >> winc;
+            else if(token=="binc") is >> binc;
+            else if(token=="movestogo") is >> movesToGo;
+            else if(token=="movetime") is >> moveTime;
+            else if(token=="depth") is >> depth;
+            else if(token=="nodes") is >> nodes;
+            else if(token=="infinite") inf = true;
+            else if(token=="ponder") ponder = true;
+        }
+
+        int myTime = (board.stm==Color::White) ? wtime : btime;
+        int myInc  = (board.stm==Color::White) ? winc : binc;
+        TimeBudget budget;
+        if(moveTime >= 0) budget = TimeBudget::fixed(std::max(1, moveTime));
+        else if(myTime >= 0) budget = allocateTime(myTime, myInc, movesToGo);
+        int maxDepth = (depth > 0) ? std::min(depth, MAX_PLY-1) : MAX_PLY-1;
+
+        {
+            std::lock_guard<std::mutex> lock(holdMutex);
+            pondering = ponder;
+            infinite = inf;
+            holdBestMove = ponder || inf;
+            ponderBudget = budget;
+        }
+
+        Board root = board;
+        pool.onIteration = [this, root](const SearchStats& s){
+            u64 nodes = s.nodes;
+            u64 nps = (s.timeMs > 0) ? nodes * 1000 / u64(s.timeMs) : nodes;
+            std::ostringstream oss;
+            oss << "info depth " << s.depthReached
+                << " score " << scoreToUCI(s.bestScore)
+                << " nodes " << nodes
+                << " nps " << nps
+                << " time " << s.timeMs;
+            if(s.tbHits) oss << " tbhits " << u64(s.tbHits);
+            std::string pv = extractPVFromTT(root, pool.tt, s.depthReached);
+            if(!pv.empty()) oss << " pv " << pv;
+            send(oss.str());
+        };
+
+        pool.gameHistory = history;
+        pool.nodeLimit = (nodes > 0) ? u64(nodes) : 0;
+        pool.prepare((ponder || inf) ? TimeBudget{} : budget);
+        searchThread = std::thread([this, root, maxDepth](){
+            Move best = pool.run(root, maxDepth);
+            reportProfile("search", pool.stats.depthReached, pool.stats.nodes + pool.stats.qnodes, pool.stats.timeMs, pool.stats.profile);
+
+            // The move we expect in reply is the second move of the PV.
+            std::string ponderMove;
+            std::istringstream pv(extractPVFromTT(root, pool.tt, 2));
+            std::string first;
+            if(pv >> first && first==moveToUCI(best)) pv >> ponderMove;
+
+            {
+                std::unique_lock<std::mutex> lock(holdMutex);
+                holdCv.wait(lock, [this](){ return !holdBestMove; });
+            }
+
+            bool none = (best.from==best.to);
+            std::string line = "bestmove " + (none ? std::string("0000") : moveToUCI(best));
+            if(!none && !ponderMove.empty()) line += " ponder " + ponderMove;
+            send(line);
+        });
+    }
+
+    void ponderhit(){
+        {
+            std::lock_guard<std::mutex> lock(holdMutex);
+            if(!pondering) return;
+            pondering = false;
+            if(!infinite) holdBestMove = false;
+        }
+        holdCv.notify_all();
+        // Our clock starts now: keep what was already searched and spend the budget on top.
+        if(!infinite) pool.setTimeBudget(ponderBudget.shiftedBy(pool.elapsedMs()));
+    }
+
+    void setOption(std::istringstream& is){
+        std::string token, name, value;
+        is >> token;   // "name"
+        while(is >> token && token!="value") name += (name.empty() ? "" : " ") + token;
+        while(is >> token) value += (value.empty() ? "" : " ") + token;
+
+        stopSearch();
+        if(name=="Hash" || name=="Large Pages"){
+            size_t mb = pool.tt.sizeMB();
+            if(name=="Hash") mb = (size_t)std::clamp(std::atoi(value.c_str()), 1, MAX_HASH_MB);
+            else pool.tt.largePages = (value=="true");
+            try {
+                pool.resizeHash(mb);
+            } catch(const std::bad_alloc&){
+                send("info string cannot allocate " + std::to_string(mb) + " MB of hash, using " + std::to_string(DEFAULT_HASH_MB));
+                pool.resizeHash(DEFAULT_HASH_MB);
+            }
+            send("info string hash " + std::to_string(pool.tt.sizeMB()) + " MB on " + pool.tt.memoryName());
+        } else if(name=="Threads"){
+            pool.setThreads(std::clamp(std::atoi(value.c_str()), 1, MAX_THREADS));
+        } else if(name=="Clear Hash"){
+            pool.clearHash();
+        } else if(name=="SyzygyPath"){
+            std::string path = (value=="<empty>") ? std::string() : value;
+            if(tbInit(path)) send("info string syzygy tables loaded, up to " + std::to_string(tbLargest()) + " men");
+            else if(!path.empty()) send("info string no syzygy tables found in " + path);
+        } else if(name=="SyzygyProbeDepth"){
+            searchConfig.tbProbeDepth = std::clamp(std::atoi(value.c_str()), 1, 100);
+        } else if(name=="SyzygyProbeLimit"){
+            searchConfig.tbProbeLimit = std::clamp(std::atoi(value.c_str()), 0, 7);
+        } else if(name=="EvalFile"){
+            std::string path = (value=="<empty>") ? std::string() : value;
+            if(!nnueLoad(path)) send("info string cannot load network " + path + ", keeping the current evaluation");
+            else if(!path.empty()) send("info string network loaded: " + nnueDescription());
+        } else if(name=="Use NNUE"){
+            evalConfig.nnue = (value=="true");
+        } else if(name=="StatsFile" && SEARCH_PROFILING){
+            statsPath = (value=="<empty>") ? std::string() : value;
+        } else if(name=="Ponder"){
+            // Informational: the GUI decides whether to send "go ponder".
+        } else {
+            send("info string unknown option: " + name);
+        }
+    }
+
+    // perft/divide <depth> [threads N] [hash MB] [fen <FEN>]: counts leaf nodes of the
+    // current position (or the given FEN), optionally per root move.
+    void perftCommand(std::istringstream& is, bool divide){
+        stopSearch();
+        int depth = 0, threads = 1, hashMB = 0;
+        is >> depth;
+        Board bd = board;
+        std::string token;
+        while(is >> token){
+            if(token=="threads") is >> threads;
+            else if(token=="hash") is >> hashMB;
+            else if(token=="fen"){
+                std::string fen, part;
+                while(is >> part) fen += (fen.empty() ? "" : " ") + part;
+                if(!bd.setFen(fen)){
+                    send("info string invalid fen: " + fen);
+                    return;
+                }
+            }
+        }
+
+        PerftTable tt;
+        tt.resizeMB((size_t)std::max(0, hashMB));
+        auto t0 = std::chrono::steady_clock::now();
+        std::vector<DivideEntry> moves = perftDivide(bd, depth, std::max(1, threads), &tt);
+        long long ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t0).count();
+
+        u64 total = 0;
+        for(const DivideEntry& d : moves){
+            total += d.nodes;
+            if(divide) send(moveToUCI(d.move) + ": " + std::to_string(d.nodes));
+        }
+        if(depth<=0) total = 1;
+
+        std::ostringstream oss;
+        oss << (divide ? "\n" : "") << "Nodes searched: " << total << "\n"
+            << "Time: " << ms << " ms\n"
+            << "NPS: " << nodesPerSecond(total, ms);
+        send(oss.str());
+    }
+
+    // perftsuite [maxDepth] [threads N] [hash MB]: checks the standard positions.
+    // Returns false if any count is wrong.
+    bool perftSuite(std::istringstream& is){
+        stopSearch();
+        int maxDepth = 99, threads = 1, hashMB = 0;
+        std::string token;
+        while(is >> token){
+            if(token=="threads") is >> threads;
+            else if(token=="hash") is >> hashMB;
+            else maxDepth = std::atoi(token.c_str());
+        }
+
+        PerftTable tt;
+        tt.resizeMB((size_t)std::max(0, hashMB));
+        bool allOk = true;
+        u64 total = 0;
+        long long totalMs = 0;
+        for(const PerftCase& c : PERFT_SUITE){
+            if(c.depth > maxDepth) continue;
+            Board bd = board;
+            bd.setFen(c.fen);
+            auto t0 = std::chrono::steady_clock::now();
+            u64 n = 0;
+            for(const DivideEntry& d : perftDivide(bd, c.depth, std::max(1, threads), &tt)) n += d.nodes;
+            long long ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t0).count();
+            bool ok = (n == c.nodes);
+            allOk &= ok;
+            total += n;
+            totalMs += ms;
+            std::ostringstream oss;
+            oss << (ok ? "ok   " : "FAIL ") << "depth " << c.depth << " nodes " << n;
+            if(!ok) oss << " expected " << c.nodes;
+            oss << " time " << ms << " ms  " << c.fen;
+            send(oss.str());
+        }
+        std::ostringstream oss;
+        oss << (allOk ? "perft suite passed" : "perft suite FAILED")
+            << ": " << total << " nodes in " << totalMs << " ms, NPS " << nodesPerSecond(total, totalMs);
+        send(oss.str());
+        return allOk;
+    }
+
+    // booktest: checks PolyglotBook::key against the published keys. Returns false on a
+    // mismatch.
+    bool bookTest(){
+        stopSearch();
+        bool allOk = true;
+        for(const BookKeyCase& c : BOOK_KEY_SUITE){
+            Board bd;
+            bd.setZobrist(&zob);
+            bd.reset();
+            std::istringstream moves(c.moves);
+            std::string uci;
+            while(moves >> uci){
+                MoveList legal;
+                bd.genLegalMoves(legal);
+                for(const Move& m : legal){
+                    if(moveToUCI(m)!=uci) continue;
+                    Undo u{};
+                    bd.makeMove(m, u);
+                    break;
+                }
+            }
+            u64 k = PolyglotBook::key(bd);
+            bool ok = (k == c.key);
+            allOk &= ok;
+            std::ostringstream oss;
+            oss << (ok ? "ok   " : "FAIL ") << std::hex << std::setw(16) << std::setfill('0') << k;
+            if(!ok) oss << " expected " << std::setw(16) << c.key;
+            oss << "  " << (*c.moves ? c.moves : "startpos");
+            send(oss.str());
+        }
+        send(allOk ? "book keys passed" : "book keys FAILED");
+        return allOk;
+    }
+
+    // bench [depth D] [threads N] [hash MB]: fixed-depth search over the bench positions.
+    // The signature only repeats exactly with one thread.
+    void bench(std::istringstream& is){
+        stopSearch();
+        int depth = 7, threads = 1, hashMB = 16;
+        std::string token;
+        while(is >> token){
+            if(token=="depth") is >> depth;
+            else if(token=="threads") is >> threads;
+            else if(token=="hash") is >> hashMB;
+            else depth = std::atoi(token.c_str());
+        }
+        depth = std::clamp(depth, 1, MAX_PLY-1);
+        threads = std::clamp(threads, 1, MAX_THREADS);
+        hashMB = std::clamp(hashMB, 1, MAX_HASH_MB);
+
+        std::ostringstream log;
+        BenchResult r = runBench(depth, threads, hashMB, log);
+        std::ostringstream oss;
+        oss << log.str()
+            << "===========================\n"
+            << "Depth           : " << depth << "\n"
+            << "Threads         : " << threads << "\n"
+            << "Positions       : " << r.positions << "\n"
+            << "Total time (ms) : " << r.timeMs << "\n"
+            << "Nodes searched  : " << r.nodes << "\n"
+            << "QNodes searched : " << r.qnodes << "\n"
+            << "Nodes/second    : " << nodesPerSecond(r.nodes + r.qnodes, r.timeMs) << "\n"
+            << "Signature       : " << r.signature;
+        send(oss.str());
+        reportProfile("bench", depth, r.signature, r.timeMs, r.profile);
+    }
+
+    // match [games N] [threads N] [depth D] [nodes N] [movetime MS] [hash MB] [maxplies N]
+    // [random N] [openings FILE] [pgn FILE] [json FILE]: self-play, several games at a time.
+    // Without a depth, node or time limit every move is searched to depth 6.
+    void match(std::istringstream& is){
+        stopSearch();
+        MatchConfig cfg;
+        cfg.threads = (int)std::max(1u, std::thread::hardware_concurrency());
+        std::string token, openings, pgnPath, jsonPath;
+        while(is >> token){
+            if(token=="games") is >> cfg.games;
+            else if(token=="threads") is >> cfg.threads;
+            else if(token=="depth") is >> cfg.depth;
+            else if(token=="nodes") is >> cfg.nodes;
+            else if(token=="movetime") is >> cfg.moveTimeMs;
+            else if(token=="hash") is >> cfg.hashMB;
+            else if(token=="maxplies") is >> cfg.maxPlies;
+            else if(token=="random") is >> cfg.randomPlies;
+            else if(token=="openings") is >> openings;
+            else if(token=="pgn") is >> pgnPath;
+            else if(token=="json") is >> jsonPath;
+        }
+        cfg.threads = std::clamp(cfg.threads, 1, MAX_THREADS);
+        cfg.hashMB = std::clamp(cfg.hashMB, 1, MAX_HASH_MB);
+        if(cfg.depth<=0 && cfg.nodes==0 && cfg.moveTimeMs<=0) cfg.depth = 6;
+        if(!openings.empty()){
+            cfg.openings = loadOpenings(openings);
+            if(cfg.openings.empty()){
+                send("info string no positions in " + openings);
+                return;
+            }
+        }
+
+        std::ofstream pgn, json;
+        if(!pgnPath.empty()) pgn.open(pgnPath);
+        if(!jsonPath.empty()) json.open(jsonPath);
+        if((!pgnPath.empty() && !pgn) || (!jsonPath.empty() && !json)){
+            send("info string cannot write match output");
+            return;
+        }
+
+        MatchResult r = runMatch(cfg, pgnPath.empty() ? nullptr : &pgn, jsonPath.empty() ? nullptr : &json);
+        std::ostringstream oss;
+        oss << "===========================\n"
+            << "Games           : " << r.games << " (" << cfg.threads << " at a time)\n"
+            << "White/draw/black: " << r.whiteWins << " / " << r.draws << " / " << r.blackWins << "\n"
+            << "Total time (ms) : " << r.timeMs << "\n"
+            << "Nodes searched  : " << r.nodes << "\n"
+            << "Nodes/second    : " << nodesPerSecond(r.nodes, r.timeMs);
+        send(oss.str());
+    }
+
+    // tune <file> [threads N] [epochs N] [batch N] [lr X] [k K] [out FILE]: Texel-tunes the
+    // hand-written evaluation weights on a file of positions with game results.
+    void tune(std::istringstream& is){
+        stopSearch();
+        TuneConfig cfg;
+        cfg.threads = (int)std::max(1u, std::thread::hardware_concurrency());
+        is >> cfg.dataPath;
+        std::string token;
+        while(is >> token){
+            if(token=="threads") is >> cfg.threads;
+            else if(token=="epochs") is >> cfg.epochs;
+            else if(token=="batch") is >> cfg.batch;
+            else if(token=="lr") is >> cfg.learningRate;
+            else if(token=="k") is >> cfg.k;
+            else if(token=="out") is >> cfg.outPath;
+        }
+        cfg.threads = std::clamp(cfg.threads, 1, MAX_THREADS);
+        cfg.batch = std::max(1, cfg.batch);
+
+        SendBuf sink(*this);
+        std::ostream log(&sink);
+        runTune(cfg, log);
+    }
+
+    // epd <file> [depth D] [movetime MS] [threads N] [hash MB]: analyses every position of a
+    // test suite and reports how many bm/am it solves. Without a limit each gets 1000 ms.
+    void epd(std::istringstream& is){
+        stopSearch();
+        EpdConfig cfg;
+        cfg.threads = (int)std::max(1u, std::thread::hardware_concurrency());
+        std::string path, token;
+        is >> path;
+        while(is >> token){
+            if(token=="depth") is >> cfg.depth;
+            else if(token=="movetime") is >> cfg.moveTimeMs;
+            else if(token=="threads") is >> cfg.threads;
+            else if(token=="hash") is >> cfg.hashMB;
+        }
+        cfg.threads = std::clamp(cfg.threads, 1, MAX_THREADS);
+        cfg.hashMB = std::clamp(cfg.hashMB, 1, MAX_HASH_MB);
+        if(cfg.depth<=0 && cfg.moveTimeMs<=0) cfg.moveTimeMs = 1000;
+
+        std::vector<EpdPosition> positions = loadEpd(path);
+        if(positions.empty()){
+            send("info string no positions in " + path);
+            return;
+        }
+        SendBuf sink(*this);
+        std::ostream log(&sink);
+        EpdResult r = runEpd(cfg, positions, log);
+
+        std::ostringstream oss;
+        oss << "===========================\n"
+            << "Positions       : " << r.positions << " (" << cfg.threads << " at a time)\n";
+        if(r.scored)
+            oss << "Solved          : " << r.solved << "/" << r.scored << " (" << std::fixed << std::setprecision(1)
+                << 100.0 * r.solved / r.scored << "%)\n";
+        if(r.maxPoints)
+            oss << "Points          : " << r.points << "/" << r.maxPoints << "\n";
+        oss << "Total time (ms) : " << r.timeMs << "\n"
+            << "Nodes searched  : " << r.nodes << "\n"
+            << "Nodes/second    : " << nodesPerSecond(r.nodes, r.timeMs);
+        send(oss.str());
+    }
+
+    // d: the current position as FEN, with its hash key.
+    void display(){
+        std::ostringstream oss;
+        oss << "Fen: " << board.fen() << "\n"
+            << "Key: " << std::hex << board.hash;
+        send(oss.str());
+    }
+
+    void identify(){
+        send(std::string("id name ") + ENGINE_NAME);
+        send(std::string("id author ") + ENGINE_AUTHOR);
+        send("option name Hash type spin default " + std::to_string(DEFAULT_HASH_MB) +
+             " min 1 max " + std::to_string(MAX_HASH_MB));
+        send("option name Large Pages type check default true");
+        send("option name Threads type spin default 1 min 1 max " + std::to_string(MAX_THREADS));
+        send("option name Ponder type check default false");
+        send("option name SyzygyPath type string default <empty>");
+        send("option name SyzygyProbeDepth type spin default 1 min 1 max 100");
+        send("option name SyzygyProbeLimit type spin default 7 min 0 max 7");
+        send("option name EvalFile type string default <empty>");
+        send("option name Use NNUE type check default true");
+        if(SEARCH_PROFILING) send("option name StatsFile type string default <empty>");
+        send("option name Clear Hash type button");
+        send("uciok");
+    }
+};
+
+int SendBuf::overflow(int c){
+    if(c=='\n'){ e.send(line); line.clear(); }
+    else if(c!=EOF) line += (char)c;
+    return c;
+}
+
+} // namespace
+
+int uciLoop(std::istream& in, std::ostream& out){
+    in.tie(nullptr);   // replies are flushed line by line; don't flush from the reader thread
+    UciEngine engine(out);
+    int exitCode = 0;
+
+    std::string line;
+    while(std::getline(in, line)){
+        std::istringstream is(line);
+        std::string cmd;
+        if(!(is >> cmd)) continue;
+
+        if(cmd=="uci") engine.identify();
+        else if(cmd=="isready") engine.send("readyok");
+        else if(cmd=="ucinewgame"){
+            engine.stopSearch();
+            engine.pool.newGame();
+            engine.board.reset();
+        }
+        else if(cmd=="position"){
+            engine.stopSearch();
+            engine.position(is);
+        }
+        else if(cmd=="go") engine.go(is);
+        else if(cmd=="stop") engine.stopSearch();
+        else if(cmd=="ponderhit") engine.ponderhit();
+        else if(cmd=="setoption") engine.setOption(is);
+        else if(cmd=="bench") engine.bench(is);
+        else if(cmd=="match") engine.match(is);
+        else if(cmd=="tune") engine.tune(is);
+        else if(cmd=="epd") engine.epd(is);
+        else if(cmd=="d") engine.display();
+        else if(cmd=="perft") engine.perftCommand(is, false);
+        else if(cmd=="divide") engine.perftCommand(is, true);
+        else if(cmd=="perftsuite"){ if(!engine.perftSuite(is)) exitCode = 1; }
+        else if(cmd=="booktest"){ if(!engine.bookTest()) exitCode = 1; }
+        else if(cmd=="quit") break;
+    }
+    engine.stopSearch();
+    return exitCode;
+}
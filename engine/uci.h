@@ -0,0 +1,9 @@
+// engine/uci.h  (Universal Chess Interface front end)
+#pragma once
+
+#include <iostream>
+
+// Reads UCI commands from in until "quit" or end of input; replies go to out.
+// Besides the UCI protocol it understands d, bench, match, tune, epd, perft, divide and
+// perftsuite. Returns non-zero if a perftsuite run failed.
+int uciLoop(std::istream& in = std::cin, std::ostream& out = std::cout);
@@ -0,0 +1,28 @@
+// engine/zobrist.h
+#pragma once
+
+#include "types.h"
+
+#include <random>
+
+struct Zobrist {
+    // [color][pieceType][square]
+    u64 psq[2][7][64]{};
+    u64 sideToMove{};
+    u64 castling[16]{};
+    u64 epFile[9]{}; // 0..7 file, 8 = "no ep"
+
+    Zobrist(){
+        std::mt19937_64 rng(0xC0FFEE1234ULL);
+        auto r64 = [&](){ return rng(); };
+
+        for(int c=0;c<2;c++)
+            for(int pt=0;pt<7;pt++)
+                for(int s=0;s<64;s++)
+                    psq[c][pt][s]=r64();
+
+        sideToMove = r64();
+        for(int i=0;i<16;i++) castling[i]=r64();
+        for(int i=0;i<9;i++) epFile[i]=r64();
+    }
+};
@@ -0,0 +1,37 @@
+#!/usr/bin/env bash
+# Builds the engine library (build/liborryx.a) and the headless UCI binary (./orryx).
+# No SFML needed. Override the compiler or flags with CXX / CXXFLAGS.
+# Syzygy probing is off unless FATHOM_DIR points at a Fathom checkout
+# (https://github.com/jdart1/Fathom); its tbprobe.c is then compiled into the library.
+# NNUE_FILE=<net.nnue> embeds a network into the binary. The NNUE kernels use AVX2 or NEON
+# only when the compiler targets them, e.g. CXXFLAGS="-O2 -march=native".
+# STATS=1 compiles in the search instrumentation (ORRYX_STATS); leave it off for play.
+set -euo pipefail
+
+CXX="${CXX:-g++}"
+CXXFLAGS="${CXXFLAGS:--O2}"
+
+mkdir -p build/obj
+objs=()
+if [ -n "${NNUE_FILE:-}" ]; then
+  CXXFLAGS="$CXXFLAGS -DORRYX_NNUE_EMBED=\"$(realpath "$NNUE_FILE")\""
+fi
+if [ "${STATS:-0}" = "1" ]; then
+  CXXFLAGS="$CXXFLAGS -DORRYX_STATS"
+fi
+if [ -n "${FATHOM_DIR:-}" ]; then
+  CXXFLAGS="$CXXFLAGS -DORRYX_SYZYGY -I$FATHOM_DIR/src"
+  ${CC:-cc} -std=gnu11 -O2 -I"$FATHOM_DIR/src" -c "$FATHOM_DIR/src/tbprobe.c" -o build/obj/tbprobe.o
+  objs+=(build/obj/tbprobe.o)
+fi
+for src in engine/*.cpp; do
+  obj="build/obj/$(basename "$src" .cpp).o"
+  $CXX -std=c++17 $CXXFLAGS -c "$src" -o "$obj"
+  objs+=("$obj")
+done
+rm -f build/liborryx.a
+ar rcs build/liborryx.a "${objs[@]}"
+
+$CXX -std=c++17 $CXXFLAGS uci_main.cpp build/liborryx.a -o orryx -pthread
+
+echo "Built ./orryx (UCI) and build/liborryx.a"
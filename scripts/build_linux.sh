@@ -1,6 +1,8 @@
 #!/usr/bin/env bash
 set -euo pipefail
 
-g++ -std=c++17 main.cpp -o gui $(pkg-config --cflags --libs sfml-graphics sfml-window sfml-system)
+"$(dirname "$0")/build_engine.sh"
+
+g++ -std=c++17 ${CXXFLAGS:--O2} main.cpp build/liborryx.a -o gui $(pkg-config --cflags --libs sfml-graphics sfml-window sfml-system) -pthread
 
 echo "Built ./gui"
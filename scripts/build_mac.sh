@@ -1,7 +1,9 @@
 #!/usr/bin/env bash
 set -euo pipefail
 
-g++ -std=c++17 main.cpp -o gui \
+"$(dirname "$0")/build_engine.sh"
+
+g++ -std=c++17 ${CXXFLAGS:--O2} main.cpp build/liborryx.a -o gui \
   -I/opt/homebrew/include \
   -L/opt/homebrew/lib \
   -lsfml-graphics -lsfml-window -lsfml-system \
@@ -0,0 +1,21 @@
+// uci_main.cpp  (headless UCI engine: no SFML, no window)
+
+#include "engine/uci.h"
+
+#include <sstream>
+#include <string>
+
+int main(int argc, char** argv){
+    // Arguments are run as one command and the engine exits, e.g. "orryx perft 6"
+    // or "orryx perftsuite 5 threads 4".
+    if(argc > 1){
+        std::string cmd;
+        for(int i=1;i<argc;i++){
+            if(i>1) cmd += ' ';
+            cmd += argv[i];
+        }
+        std::istringstream in(cmd);
+        return uciLoop(in, std::cout);
+    }
+    return uciLoop();
+}